@@ -0,0 +1,139 @@
+import React, { useLayoutEffect, useState } from "react";
+import { Rect, Screen, Scroll, Text, insetContent, type Color } from "@vitadeck/sdk";
+
+// Synthetic workloads for tests/bench_harness.c. Every step is one state update, one React
+// commit and one swap: the next step is scheduled from a timer set after the commit, so the
+// JS loop publishes the snapshot before it starts. Scenario boundaries are logged as
+// "BENCH begin <name>" / "BENCH end <name> <steps>" and the run ends with "BENCH done"; the
+// harness samples the native counters when it sees those lines.
+
+const BG_COLOR: Color = { r: 13, g: 27, b: 42, a: 255 };
+const SURFACE: Color = { r: 27, g: 38, b: 59, a: 255 };
+const SURFACE_ALT: Color = { r: 65, g: 90, b: 119, a: 255 };
+const TEXT_COLOR: Color = { r: 224, g: 225, b: 221, a: 255 };
+
+const LIST_ROWS = 1000;
+const NESTING_DEPTH = 64;
+const CHURN_ROWS = 200;
+
+type ScenarioProps = { step: number };
+
+type Scenario = {
+  name: string;
+  steps: number;
+  Component: (props: ScenarioProps) => React.ReactElement;
+};
+
+// One text node rewritten every step.
+function Counter({ step }: ScenarioProps) {
+  const inset = insetContent();
+  return (
+    <Text x={inset.x} y={inset.y} fontSize={26} color={TEXT_COLOR}>
+      {`Count ${step}`}
+    </Text>
+  );
+}
+
+// A long scroll list whose every row label changes each step.
+function LargeList({ step }: ScenarioProps) {
+  const inset = insetContent();
+  const rows = [];
+  for (let i = 0; i < LIST_ROWS; i++) {
+    rows.push(
+      <Rect key={i} x={0} y={0} width={inset.width - 20} height={24} color={i % 2 === 0 ? SURFACE : SURFACE_ALT}>
+        <Text x={8} y={4} fontSize={14} color={TEXT_COLOR}>
+          {`Row ${i} / ${step}`}
+        </Text>
+      </Rect>,
+    );
+  }
+  return (
+    <Scroll x={inset.x} y={inset.y} width={inset.width} height={inset.height} gap={2} padding={10}>
+      {rows}
+    </Scroll>
+  );
+}
+
+// A deep chain of rects with a changing leaf, so every step dirties the whole ancestor path.
+function DeepNesting({ step }: ScenarioProps) {
+  let node = (
+    <Text x={1} y={1} fontSize={14} color={TEXT_COLOR}>
+      {`Leaf ${step}`}
+    </Text>
+  );
+  for (let depth = NESTING_DEPTH - 1; depth >= 0; depth--) {
+    node = (
+      <Rect x={1} y={1} width={400 - depth * 4} height={400 - depth * 4} color={depth % 2 ? SURFACE : SURFACE_ALT}>
+        {node}
+      </Rect>
+    );
+  }
+  return node;
+}
+
+// A block of rows mounted on even steps and unmounted on odd ones.
+function MountChurn({ step }: ScenarioProps) {
+  const inset = insetContent();
+  if (step % 2 === 1) return <Rect x={inset.x} y={inset.y} width={10} height={10} color={SURFACE} />;
+  const rows = [];
+  for (let i = 0; i < CHURN_ROWS; i++) {
+    rows.push(
+      <Rect key={i} x={inset.x + (i % 10) * 90} y={inset.y + Math.floor(i / 10) * 24} width={86} height={20}>
+        <Text x={4} y={2} fontSize={12} color={TEXT_COLOR}>
+          {`Item ${i}`}
+        </Text>
+      </Rect>,
+    );
+  }
+  return (
+    <Rect x={0} y={0} width={960} height={544}>
+      {rows}
+    </Rect>
+  );
+}
+
+const SCENARIOS: Scenario[] = [
+  { name: "counter", steps: 600, Component: Counter },
+  { name: "list", steps: 60, Component: LargeList },
+  { name: "nesting", steps: 300, Component: DeepNesting },
+  { name: "churn", steps: 200, Component: MountChurn },
+];
+
+type RunState = { scenario: number; step: number };
+
+export default function BenchDeckApp() {
+  const [run, setRun] = useState<RunState>({ scenario: -1, step: 0 });
+
+  useLayoutEffect(() => {
+    if (run.scenario >= SCENARIOS.length) return undefined;
+    const id = setTimeout(() => {
+      const current = SCENARIOS[run.scenario];
+      if (current && run.step < current.steps) {
+        setRun({ scenario: run.scenario, step: run.step + 1 });
+        return;
+      }
+      if (current) console.log(`BENCH end ${current.name} ${current.steps}`);
+      const next = SCENARIOS[run.scenario + 1];
+      if (next) {
+        console.log(`BENCH begin ${next.name}`);
+      } else {
+        console.log("BENCH done");
+      }
+      setRun({ scenario: run.scenario + 1, step: 0 });
+    }, 0);
+    return () => clearTimeout(id);
+  }, [run]);
+
+  const scenario = SCENARIOS[run.scenario];
+  return (
+    <Screen color={BG_COLOR}>
+      {scenario ? (
+        <scenario.Component step={run.step} />
+      ) : (
+        <Text x={20} y={20} fontSize={26} color={TEXT_COLOR}>
+          {run.scenario < 0 ? "BENCH_READY" : "BENCH_DONE"}
+        </Text>
+      )}
+    </Screen>
+  );
+}
@@ -0,0 +1 @@
+/// <reference types="@vitadeck/sdk/deck-app-env" />
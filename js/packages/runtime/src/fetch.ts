@@ -4,6 +4,26 @@ export interface VitaRequestInit {
   method?: string;
   headers?: VitaHeadersInit;
   body?: string;
+  // Settle as soon as the body starts and read it in chunks through `response.body`. Read the body
+  // to the end, cancel it, or drop the Response: until then the transfer holds a fetch slot.
+  stream?: boolean;
+}
+
+export type VitaReadResult = { done: false; value: Uint8Array } | { done: true; value: undefined };
+
+export interface VitaStreamReader {
+  read(): Promise<VitaReadResult>;
+  cancel(): Promise<void>;
+  releaseLock(): void;
+}
+
+// The subset of ReadableStream that Deck Apps need. Chunks are the body bytes as received; decode
+// them with a streaming TextDecoder, since a chunk can end inside a multi-byte character.
+export interface VitaReadableStream {
+  readonly locked: boolean;
+  getReader(): VitaStreamReader;
+  cancel(): Promise<void>;
+  [Symbol.asyncIterator](): AsyncIterator<Uint8Array>;
 }
 
 export interface VitaResponse {
@@ -11,47 +31,242 @@ export interface VitaResponse {
   readonly ok: boolean;
   readonly statusText: string;
   readonly headers: Record<string, string>;
+  readonly body: VitaReadableStream;
+  readonly bodyUsed: boolean;
+  arrayBuffer(): Promise<ArrayBuffer>;
   text(): Promise<string>;
   json<T = unknown>(): Promise<T>;
 }
 
+type NativeResponse = Awaited<ReturnType<typeof nativeFetch>>;
+
 function normalizeHeaders(init?: VitaHeadersInit): string[] {
   if (!init) return [];
   const entries = Array.isArray(init) ? init : Object.entries(init);
   return entries.map(([key, value]) => `${key}: ${value}`);
 }
 
+// Length of the longest prefix of bytes that does not end inside a UTF-8 sequence.
+function utf8CompleteLength(bytes: Uint8Array): number {
+  const len = bytes.length;
+  let start = len;
+  while (start > 0 && len - start < 3 && (bytes[start - 1] & 0xc0) === 0x80) start--;
+  if (start === 0) return len;
+  const lead = bytes[start - 1];
+  const need = lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : 1;
+  return len - (start - 1) < need ? start - 1 : len;
+}
+
+function concatBytes(chunks: Uint8Array[]): ArrayBuffer {
+  if (chunks.length === 1) {
+    const [chunk] = chunks;
+    if (chunk.byteOffset === 0 && chunk.byteLength === chunk.buffer.byteLength) return chunk.buffer as ArrayBuffer;
+  }
+  let size = 0;
+  for (const chunk of chunks) size += chunk.byteLength;
+  const bytes = new Uint8Array(size);
+  let offset = 0;
+  for (const chunk of chunks) {
+    bytes.set(chunk, offset);
+    offset += chunk.byteLength;
+  }
+  return bytes.buffer as ArrayBuffer;
+}
+
+// UTF-8 only. With `{ stream: true }` an incomplete trailing character is held back for the next call.
+export class TextDecoder {
+  readonly encoding = "utf-8";
+  #pending: Uint8Array | undefined;
+
+  constructor(label = "utf-8") {
+    if (!/^utf-?8$/i.test(label.trim())) throw new RangeError(`TextDecoder: unsupported encoding ${label}`);
+  }
+
+  decode(input?: ArrayBuffer | ArrayBufferView, options?: { stream?: boolean }): string {
+    let bytes =
+      input === undefined
+        ? new Uint8Array(0)
+        : input instanceof ArrayBuffer
+          ? new Uint8Array(input)
+          : new Uint8Array(input.buffer, input.byteOffset, input.byteLength);
+    if (this.#pending) {
+      bytes = new Uint8Array(concatBytes([this.#pending, bytes]));
+      this.#pending = undefined;
+    }
+    const cut = options?.stream ? utf8CompleteLength(bytes) : bytes.length;
+    if (cut < bytes.length) this.#pending = bytes.slice(cut);
+    if (cut === 0) return "";
+    return nativeDecodeText(concatBytes([bytes.subarray(0, cut)]));
+  }
+}
+
+class BodyStream implements VitaReadableStream {
+  #reader: VitaStreamReader | undefined;
+  readonly #next: () => Promise<Uint8Array | undefined>;
+  readonly #cancel: () => void;
+  readonly #onLock: () => void;
+  #closed = false;
+
+  constructor(next: () => Promise<Uint8Array | undefined>, cancel: () => void, onLock: () => void) {
+    this.#next = next;
+    this.#cancel = cancel;
+    this.#onLock = onLock;
+  }
+
+  get locked(): boolean {
+    return this.#reader !== undefined;
+  }
+
+  getReader(): VitaStreamReader {
+    if (this.#reader) throw new TypeError("The body stream is already locked to a reader");
+    this.#onLock();
+    const reader: VitaStreamReader = {
+      read: async () => {
+        if (this.#closed) return { done: true, value: undefined };
+        const value = await this.#next();
+        if (value === undefined) {
+          this.#closed = true;
+          return { done: true, value: undefined };
+        }
+        return { done: false, value };
+      },
+      cancel: () => this.cancel(),
+      releaseLock: () => {
+        if (this.#reader === reader) this.#reader = undefined;
+      },
+    };
+    this.#reader = reader;
+    return reader;
+  }
+
+  cancel(): Promise<void> {
+    if (!this.#closed) {
+      this.#closed = true;
+      this.#cancel();
+    }
+    return Promise.resolve();
+  }
+
+  async *[Symbol.asyncIterator](): AsyncIterator<Uint8Array> {
+    const reader = this.getReader();
+    try {
+      for (;;) {
+        const result = await reader.read();
+        if (result.done) return;
+        yield result.value;
+      }
+    } finally {
+      reader.releaseLock();
+    }
+  }
+}
+
+// The stream closures are the only references to the native handle. Once the Response and its
+// body are dropped, QuickJS frees the handle and the native side cancels the transfer, so an app
+// that never reads a streamed body does not keep one of the few concurrent fetch slots. Keeping a
+// Response alive without reading or cancelling its body still holds the slot: call
+// `response.body.cancel()` when the body is not needed.
+function nativeBodyStream(stream: NativeFetchStream, onLock: () => void): BodyStream {
+  return new BodyStream(
+    async () => {
+      const chunk = await nativeFetchRead(stream);
+      return chunk && new Uint8Array(chunk);
+    },
+    () => nativeFetchCancel(stream),
+    onLock,
+  );
+}
+
+// The whole body as one chunk, a view of the native buffer.
+function bufferedBodyStream(body: ArrayBuffer, onLock: () => void): BodyStream {
+  let pending: ArrayBuffer | undefined = body;
+  return new BodyStream(
+    () => {
+      const chunk = pending;
+      pending = undefined;
+      return Promise.resolve(chunk && chunk.byteLength > 0 ? new Uint8Array(chunk) : undefined);
+    },
+    () => {
+      pending = undefined;
+    },
+    onLock,
+  );
+}
+
 class Response implements VitaResponse {
   readonly status: number;
   readonly ok: boolean;
   readonly statusText: string;
   readonly headers: Record<string, string>;
-  readonly #body: string;
+  readonly body: VitaReadableStream;
+  // The native body buffer of a buffered response; text is decoded from it only on demand.
+  readonly #buffer: ArrayBuffer | undefined;
+  #bodyUsed = false;
+  #reading = false;
 
-  constructor(native: Awaited<ReturnType<typeof nativeFetch>>) {
+  constructor(native: NativeResponse) {
     this.status = native.status;
     this.ok = native.ok;
     this.statusText = native.statusText;
     this.headers = native.headers;
-    this.#body = native.body;
+    // Taking a reader uses the body, except for the reader the body methods take themselves.
+    const onLock = () => {
+      if (!this.#reading) this.#bodyUsed = true;
+    };
+    if (native.stream === undefined) {
+      this.#buffer = native.body;
+      this.body = bufferedBodyStream(native.body, onLock);
+    } else {
+      this.body = nativeBodyStream(native.stream, onLock);
+    }
+  }
+
+  get bodyUsed(): boolean {
+    return this.#bodyUsed;
+  }
+
+  #consume(): void {
+    if (this.#bodyUsed || this.body.locked) throw new TypeError("The response body has already been read");
+    this.#bodyUsed = true;
+  }
+
+  // Buffered responses hand out the native buffer itself, without a copy.
+  async arrayBuffer(): Promise<ArrayBuffer> {
+    this.#consume();
+    if (this.#buffer) return this.#buffer;
+    return this.#readAll();
+  }
+
+  // Streamed bodies are decoded once, whole, so a character split across chunks decodes correctly.
+  async text(): Promise<string> {
+    this.#consume();
+    return nativeDecodeText(this.#buffer ?? (await this.#readAll()));
   }
 
-  text(): Promise<string> {
-    return Promise.resolve(this.#body);
+  async #readAll(): Promise<ArrayBuffer> {
+    const chunks: Uint8Array[] = [];
+    this.#reading = true;
+    try {
+      for await (const chunk of this.body) chunks.push(chunk);
+    } finally {
+      this.#reading = false;
+    }
+    return concatBytes(chunks);
   }
 
-  json<T = unknown>(): Promise<T> {
-    return Promise.resolve(JSON.parse(this.#body) as T);
+  async json<T = unknown>(): Promise<T> {
+    return JSON.parse(await this.text()) as T;
   }
 }
 
 export async function fetch(url: string, init?: VitaRequestInit): Promise<VitaResponse> {
   const method = (init?.method ?? "GET").toUpperCase();
   const headers = normalizeHeaders(init?.headers);
-  const native = await nativeFetch(url, method, headers, init?.body);
+  const native = await nativeFetch(url, method, headers, init?.body, init?.stream ?? false);
   return new Response(native);
 }
 
 export function installFetch(): void {
   globalThis.fetch = fetch;
+  globalThis.TextDecoder = TextDecoder;
 }
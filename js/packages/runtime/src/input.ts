@@ -4,13 +4,25 @@ type EventHandlers = {
   onPressEnd?: () => void;
 };
 
-type NativeInputEventType = "mouseenter" | "mouseleave" | "mousedown" | "mouseup" | "click";
+// Mirrors InputEventKind in src/core/event_queue.h.
+const InputEventKind = {
+  MouseEnter: 0,
+  MouseLeave: 1,
+  MouseDown: 2,
+  MouseUp: 3,
+  Click: 4,
+} as const;
 
-// Map of instance IDs to their event handlers
-const handlersById = new Map<string, EventHandlers>();
+// Each native event is a (target handle, kind, getTime() seconds) triple.
+const INPUT_EVENT_STRIDE = 3;
+
+let lastInputEventTime = 0;
+
+// Map of instance handles to their event handlers
+const handlersById = new Map<number, EventHandlers>();
 
 // Register event handlers for an instance
-export function registerHandlers(id: string, handlers: EventHandlers): void {
+export function registerHandlers(id: number, handlers: EventHandlers): void {
   // Only store if there are any handlers
   if (handlers.onPress || handlers.onPressStart || handlers.onPressEnd) {
     handlersById.set(id, handlers);
@@ -18,7 +30,7 @@ export function registerHandlers(id: string, handlers: EventHandlers): void {
 }
 
 // Update event handlers for an instance
-export function updateHandlers(id: string, handlers: EventHandlers): void {
+export function updateHandlers(id: number, handlers: EventHandlers): void {
   if (handlers.onPress || handlers.onPressStart || handlers.onPressEnd) {
     handlersById.set(id, handlers);
   } else {
@@ -28,31 +40,37 @@ export function updateHandlers(id: string, handlers: EventHandlers): void {
 }
 
 // Unregister handlers when instance is destroyed
-export function unregisterHandlers(id: string): void {
+export function unregisterHandlers(id: number): void {
   handlersById.delete(id);
 }
 
-// Called from native when an input event occurs
-export function onInputEventFromNative(
-  id: string,
-  type: NativeInputEventType,
-): void {
+// Native timestamp of the most recently dispatched input event, in getTime() seconds.
+export function getLastInputEventTime(): number {
+  return lastInputEventTime;
+}
+
+function dispatchInputEvent(id: number, kind: number): void {
   const handlers = handlersById.get(id);
   if (!handlers) return;
 
-  switch (type) {
-    case "mouseenter":
-      break;
-    case "mouseleave":
-      break;
-    case "mousedown":
+  switch (kind) {
+    case InputEventKind.MouseDown:
       handlers.onPressStart?.();
       break;
-    case "mouseup":
+    case InputEventKind.MouseUp:
       handlers.onPressEnd?.();
       break;
-    case "click":
+    case InputEventKind.Click:
       handlers.onPress?.();
       break;
   }
 }
+
+// Called from native once per JS loop iteration with every event queued since the last call
+export function onInputEventsFromNative(buffer: ArrayBuffer): void {
+  const events = new Float64Array(buffer);
+  for (let i = 0; i + INPUT_EVENT_STRIDE <= events.length; i += INPUT_EVENT_STRIDE) {
+    lastInputEventTime = events[i + 2] ?? lastInputEventTime;
+    dispatchInputEvent(events[i] ?? 0, events[i + 1] ?? -1);
+  }
+}
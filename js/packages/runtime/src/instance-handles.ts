@@ -0,0 +1,29 @@
+// Dense 32-bit instance handles shared with native (see InstanceHandle in src/ui/instance_tree.h).
+// The low bits index a native registry slot; the high bits are a generation bumped on release,
+// so a stale handle never aliases the next instance that reuses the slot. 0 is reserved for
+// the root container.
+const INDEX_BITS = 20;
+const INDEX_MASK = (1 << INDEX_BITS) - 1;
+const GENERATION_MASK = 0xfff;
+
+export const ROOT_HANDLE = 0;
+
+const generations: number[] = [];
+const freeIndices: number[] = [];
+let nextIndex = 1;
+
+export function allocateHandle(): number {
+  let index = freeIndices.pop();
+  if (index === undefined) {
+    if (nextIndex > INDEX_MASK) throw new Error("Out of instance handles");
+    index = nextIndex++;
+    generations[index] = 1;
+  }
+  return ((generations[index] << INDEX_BITS) | index) >>> 0;
+}
+
+export function releaseHandle(handle: number): void {
+  const index = handle & INDEX_MASK;
+  generations[index] = (generations[index] + 1) & GENERATION_MASK || 1;
+  freeIndices.push(index);
+}
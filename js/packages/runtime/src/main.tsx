@@ -3,7 +3,7 @@ import { ThemeProvider } from "@vitadeck/sdk/internal";
 import React, { StrictMode, type ComponentType } from "react";
 import * as reactCompilerRuntime from "react-compiler-runtime";
 import { installFetch } from "./fetch";
-import { onInputEventFromNative } from "./input";
+import { onInputEventsFromNative } from "./input";
 import type { MetricSummary } from "./reconciler-metrics";
 import { getMetrics, render, resetMetrics } from "./vitadeck-react-reconciler-mutation";
 
@@ -72,7 +72,7 @@ export function updateContainer() {
 }
 
 export const input = {
-  onInputEventFromNative,
+  onInputEventsFromNative,
 };
 
 const METRICS_REFRESH_MS = 1500;
@@ -127,6 +127,10 @@ export const metrics = {
   startLogging: startMetricsLogging,
   stopLogging: stopMetricsLogging,
   isLogging: () => metricsIntervalId !== null,
+  inputLatency: () => nativeGetInputLatency(),
+  resetInputLatency: () => nativeResetInputLatency(),
+  startProfile: () => nativeProfileStart(),
+  stopProfile: (path?: string) => nativeProfileStop(path),
 };
 
 console.debug("runtime.tsx loaded");
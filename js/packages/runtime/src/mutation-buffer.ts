@@ -0,0 +1,145 @@
+import type { Color } from "@vitadeck/sdk/types";
+
+// Opcodes and layouts of the command stream decoded by src/jslib/instance.c.
+// Every field is a little-endian 32-bit word; instances are handles from instance-handles.ts
+// and strings are indices into a per-flush string table.
+export const MutationOp = {
+  Create: 1,
+  Update: 2,
+  AppendChild: 3,
+  InsertBefore: 4,
+  RemoveChild: 5,
+  Destroy: 6,
+  ClearContainer: 7,
+} as const;
+
+export const NodeType = {
+  Rect: 1,
+  Text: 2,
+  Button: 3,
+  RawText: 4,
+  Scroll: 5,
+  Image: 6,
+} as const;
+
+// Kinds of the prop fields that follow a Create (all fields) or Update (mask + changed fields).
+export const FieldKind = {
+  I32: 0,
+  Bool: 1,
+  F32: 2,
+  Color: 3,
+  String: 4,
+} as const;
+
+export type FieldKindValue = (typeof FieldKind)[keyof typeof FieldKind];
+export type FieldValue = number | string;
+
+export const ALL_FIELDS = 0xffffffff;
+
+export const packColor = (color: Color): number =>
+  ((color.r & 0xff) | ((color.g & 0xff) << 8) | ((color.b & 0xff) << 16) | ((color.a & 0xff) << 24)) >>> 0;
+
+const STRING_NONE = 0xffffffff;
+const INITIAL_CAPACITY = 4096;
+
+// Accumulates host operations and hands them to native in a single call per flush.
+export class MutationBuffer {
+  private buffer = new ArrayBuffer(INITIAL_CAPACITY);
+  private view = new DataView(this.buffer);
+  private offset = 0;
+  private strings: string[] = [];
+  private stringIndex = new Map<string, number>();
+
+  get isEmpty(): boolean {
+    return this.offset === 0;
+  }
+
+  op(op: number): this {
+    return this.u32(op);
+  }
+
+  u32(value: number): this {
+    this.reserve(4);
+    this.view.setUint32(this.offset, value >>> 0, true);
+    this.offset += 4;
+    return this;
+  }
+
+  i32(value: number): this {
+    this.reserve(4);
+    this.view.setInt32(this.offset, value | 0, true);
+    this.offset += 4;
+    return this;
+  }
+
+  f32(value: number): this {
+    this.reserve(4);
+    this.view.setFloat32(this.offset, value, true);
+    this.offset += 4;
+    return this;
+  }
+
+  bool(value: boolean): this {
+    return this.u32(value ? 1 : 0);
+  }
+
+  color(color: Color): this {
+    return this.u32(packColor(color));
+  }
+
+  // null encodes "no string".
+  string(value: string | null): this {
+    if (value === null) return this.u32(STRING_NONE);
+    let index = this.stringIndex.get(value);
+    if (index === undefined) {
+      index = this.strings.length;
+      this.strings.push(value);
+      this.stringIndex.set(value, index);
+    }
+    return this.u32(index);
+  }
+
+  // Write the values whose bit is set in mask; colors are pre-packed and bools are 0/1.
+  fields(kinds: readonly FieldKindValue[], values: readonly FieldValue[], mask: number): this {
+    for (let i = 0; i < kinds.length; i++) {
+      if (!(mask & (1 << i))) continue;
+      const value = values[i];
+      switch (kinds[i]) {
+        case FieldKind.I32:
+          this.i32(value as number);
+          break;
+        case FieldKind.F32:
+          this.f32(value as number);
+          break;
+        case FieldKind.Bool:
+        case FieldKind.Color:
+          this.u32(value as number);
+          break;
+        case FieldKind.String:
+          this.string(value as string);
+          break;
+      }
+    }
+    return this;
+  }
+
+  flush(): void {
+    if (this.offset === 0) return;
+    const strings = this.strings;
+    const length = this.offset;
+    this.offset = 0;
+    this.strings = [];
+    this.stringIndex.clear();
+    nativeApplyMutations(this.buffer, length, strings);
+  }
+
+  private reserve(bytes: number): void {
+    if (this.offset + bytes <= this.buffer.byteLength) return;
+    let capacity = this.buffer.byteLength * 2;
+    while (capacity < this.offset + bytes) capacity *= 2;
+    const next = new ArrayBuffer(capacity);
+    new Uint8Array(next).set(new Uint8Array(this.buffer, 0, this.offset));
+    this.buffer = next;
+    this.view = new DataView(next);
+  }
+}
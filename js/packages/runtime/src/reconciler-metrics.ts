@@ -20,6 +20,13 @@ function now(): number {
   return 0;
 }
 
+// Forwards a timed call to the native profiler, which ignores it unless a capture is running.
+function profileZone(methodName: string, startMs: number, durationMs: number) {
+  if (typeof nativeProfileZone === "function") {
+    nativeProfileZone(methodName, startMs, durationMs);
+  }
+}
+
 function isPromiseLike<T = unknown>(value: unknown): value is PromiseLike<T> {
   return value !== null && typeof value === "object" && typeof (value as PromiseLike<T>).then === "function";
 }
@@ -97,22 +104,28 @@ export class ReconcilerMetrics {
         const promise = Promise.resolve(result);
         return promise.then(
           (value) => {
-            this.record(methodName, now() - start);
+            this.finish(methodName, start);
             return value;
           },
           (error) => {
-            this.record(methodName, now() - start);
+            this.finish(methodName, start);
             throw error;
           },
         ) as ReturnType<F>;
       }
-      this.record(methodName, now() - start);
+      this.finish(methodName, start);
       return result;
     } catch (error) {
-      this.record(methodName, now() - start);
+      this.finish(methodName, start);
       throw error;
     }
   }
+
+  private finish(methodName: string, start: number) {
+    const durationMs = now() - start;
+    this.record(methodName, durationMs);
+    profileZone(methodName, start, durationMs);
+  }
 }
 
 type AnyRecord = Record<string, unknown>;
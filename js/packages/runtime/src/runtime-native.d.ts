@@ -2,6 +2,7 @@ import * as React from "react";
 import type * as ReactCompilerRuntime from "react-compiler-runtime";
 import type { ColorsMap } from "@vitadeck/sdk/types";
 import type * as VitaDeckSdk from "@vitadeck/sdk";
+import type { TextDecoder as VitaTextDecoder, VitaResponse } from "./fetch";
 
 declare global {
   function getTime(): number;
@@ -15,193 +16,64 @@ declare global {
   };
   function setInterval(callback: () => void, delay: number): number;
   function clearInterval(id: number): void;
-  function nativeCreateRect(
-    id: string,
-    x: number,
-    y: number,
-    width: number,
-    height: number,
-    hasFill: boolean,
-    fillR: number,
-    fillG: number,
-    fillB: number,
-    fillA: number,
-    hasOutline: boolean,
-    outlineR: number,
-    outlineG: number,
-    outlineB: number,
-    outlineA: number,
-    borderRadius: number,
-  ): void;
 
-  function nativeCreateText(
-    id: string,
-    fontName: string,
-    fontSize: number,
-    hasColor: boolean,
-    colorR: number,
-    colorG: number,
-    colorB: number,
-    colorA: number,
-    border: boolean,
-    x: number,
-    y: number,
-    width: number,
-    lineHeight: number,
-    align: number,
-    wrap: number,
-  ): void;
+  // Applies a command stream encoded by MutationBuffer (see mutation-buffer.ts).
+  function nativeApplyMutations(buffer: ArrayBuffer, byteLength: number, strings: string[]): void;
 
-  function nativeCreateButton(
-    id: string,
-    x: number,
-    y: number,
-    width: number,
-    height: number,
-    colorR: number,
-    colorG: number,
-    colorB: number,
-    colorA: number,
-    label: string,
-    fontSize: number,
-    borderRadius: number,
-    textColorR: number,
-    textColorG: number,
-    textColorB: number,
-    textColorA: number,
-  ): void;
+  function nativeCommit(): void;
 
-  function nativeCreateScroll(
-    id: string,
-    x: number,
-    y: number,
-    width: number,
-    height: number,
-    hasFill: boolean,
-    fillR: number,
-    fillG: number,
-    fillB: number,
-    fillA: number,
-    gap: number,
-    padding: number,
-  ): void;
-
-  function nativeCreateImage(
-    id: string,
-    imageName: string,
-    x: number,
-    y: number,
-    width: number,
-    height: number,
-  ): void;
-
-  function nativeCreateRawText(id: string, text: string): void;
-
-  function nativeAppendChild(parentId: string, childId: string): void;
-  function nativeInsertBefore(parentId: string, childId: string, beforeId: string): void;
-  function nativeRemoveChild(parentId: string, childId: string): void;
-  function nativeDestroyInstance(id: string): void;
-
-  function nativeUpdateRect(
-    id: string,
-    x: number,
-    y: number,
-    width: number,
-    height: number,
-    hasFill: boolean,
-    fillR: number,
-    fillG: number,
-    fillB: number,
-    fillA: number,
-    hasOutline: boolean,
-    outlineR: number,
-    outlineG: number,
-    outlineB: number,
-    outlineA: number,
-    borderRadius: number,
-  ): void;
-
-  function nativeUpdateText(
-    id: string,
-    fontName: string,
-    fontSize: number,
-    hasColor: boolean,
-    colorR: number,
-    colorG: number,
-    colorB: number,
-    colorA: number,
-    border: boolean,
-    x: number,
-    y: number,
-    width: number,
-    lineHeight: number,
-    align: number,
-    wrap: number,
-  ): void;
-
-  function nativeUpdateButton(
-    id: string,
-    x: number,
-    y: number,
-    width: number,
-    height: number,
-    colorR: number,
-    colorG: number,
-    colorB: number,
-    colorA: number,
-    label: string,
-    fontSize: number,
-    borderRadius: number,
-    textColorR: number,
-    textColorG: number,
-    textColorB: number,
-    textColorA: number,
-  ): void;
-
-  function nativeUpdateScroll(
-    id: string,
-    x: number,
-    y: number,
-    width: number,
-    height: number,
-    hasFill: boolean,
-    fillR: number,
-    fillG: number,
-    fillB: number,
-    fillA: number,
-    gap: number,
-    padding: number,
-  ): void;
-
-  function nativeUpdateImage(
-    id: string,
-    imageName: string,
-    x: number,
-    y: number,
-    width: number,
-    height: number,
-  ): void;
+  type InputLatencyStage = "queue" | "dispatch" | "commit" | "publish" | "present" | "total";
+  type InputLatencyStats = {
+    count: number;
+    meanMs: number;
+    p50Ms: number;
+    p95Ms: number;
+    p99Ms: number;
+    maxMs: number;
+  };
 
-  function nativeUpdateRawText(id: string, text: string): void;
+  // Input-to-photon latency histograms per stage (see src/core/latency.h).
+  function nativeGetInputLatency(): Record<InputLatencyStage, InputLatencyStats>;
+  function nativeResetInputLatency(): void;
 
-  function nativeClearContainer(): void;
+  // Chrome trace capture across the UI, JS and worker threads (see src/core/profiler.h).
+  // nativeProfileStop writes the trace and returns its path; it throws when no capture is running
+  // or the file cannot be written.
+  function nativeProfileStart(): boolean;
+  function nativeProfileStop(path?: string): string;
+  function nativeProfileZone(name: string, startMs: number, durationMs: number): void;
 
   function nativeReadTextFile(path: string): string;
   function nativeEvalFile(path: string): void;
   function nativeGetActiveDeckAppPath(): string;
 
+  // Opaque native handle of a streaming response body. Collecting it cancels the transfer.
+  interface NativeFetchStream {
+    readonly __nativeFetchStream: never;
+  }
+
+  // body is the response bytes in a buffer that owns the native memory. With stream set, the
+  // promise settles once the body starts: body is empty and stream is the handle to read the body
+  // from with nativeFetchRead.
   function nativeFetch(
     url: string,
     method: string,
     headers: string[],
     body?: string,
+    stream?: boolean,
   ): Promise<{
     status: number;
     ok: boolean;
     statusText: string;
     headers: Record<string, string>;
-    body: string;
+    body: ArrayBuffer;
+    stream?: NativeFetchStream;
   }>;
+  // Next chunk of body bytes, or undefined once the body has ended. One read at a time per stream.
+  function nativeFetchRead(stream: NativeFetchStream): Promise<ArrayBuffer | undefined>;
+  function nativeFetchCancel(stream: NativeFetchStream): void;
+  // The buffer's bytes decoded as UTF-8 (QuickJS has no TextDecoder).
+  function nativeDecodeText(buffer: ArrayBuffer): string;
 
   function fetch(
     url: string,
@@ -209,15 +81,10 @@ declare global {
       method?: string;
       headers?: Record<string, string> | Array<[string, string]>;
       body?: string;
+      stream?: boolean;
     },
-  ): Promise<{
-    status: number;
-    ok: boolean;
-    statusText: string;
-    headers: Record<string, string>;
-    text(): Promise<string>;
-    json<T = unknown>(): Promise<T>;
-  }>;
+  ): Promise<VitaResponse>;
+  var TextDecoder: typeof VitaTextDecoder;
 
   var React: typeof React;
   var reactCompilerRuntime: typeof ReactCompilerRuntime;
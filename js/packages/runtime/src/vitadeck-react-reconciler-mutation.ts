@@ -1,29 +1,37 @@
-import type { Color } from "@vitadeck/sdk/types";
 import type { VitaHostPropsByType } from "@vitadeck/sdk/vitadeck-host-types";
 import type { ReactNode } from "react";
 import Reconciler, { type HostConfig } from "react-reconciler";
 import { registerHandlers, unregisterHandlers, updateHandlers } from "./input";
+import { allocateHandle, releaseHandle, ROOT_HANDLE } from "./instance-handles";
+import {
+  ALL_FIELDS,
+  FieldKind,
+  type FieldKindValue,
+  type FieldValue,
+  MutationBuffer,
+  MutationOp,
+  NodeType,
+  packColor,
+} from "./mutation-buffer";
 import { instrumentHostConfig, ReconcilerMetrics } from "./reconciler-metrics";
 import { exhaustiveGuard } from "./utils";
 
-const generateRandomSegment = () => Math.random().toString(36).slice(2, 15);
-const generateInstanceId = (): string => {
-  return generateRandomSegment() + generateRandomSegment() + generateRandomSegment() + generateRandomSegment();
-};
-
 type Type = keyof VitaHostPropsByType;
 type Props = VitaHostPropsByType[Type] & { key?: string };
 type PropsByType = { [K in Type]: VitaHostPropsByType[K] };
 type HostContext = { root: boolean };
-type UpdatePayload = { props: string[] } | null;
+// Changed native fields (see diffFields) plus the full new encoding they index into
+type UpdatePayload = { mask: number; fields: FieldValue[] } | null;
 
 type Instance = {
-  id: string;
+  id: number;
   type: Type;
+  // Raw text children, destroyed with this instance (see destroyTextChildren)
+  texts?: Set<TextInstance>;
 };
 
 type TextInstance = {
-  id: string;
+  id: number;
   type: "RawText";
 };
 
@@ -56,12 +64,17 @@ const logReconcilerFunction = (name: string, ...args: unknown[]) => {
   if (TRACE) console.log(`[MutationReconciler]: ${name}`, ...args);
 };
 
-// Helper to extract color components or defaults
-const colorToArgs = (color: Color | undefined, defaultColor: Color): [boolean, number, number, number, number] => {
-  if (color) {
-    return [true, color.r, color.g, color.b, color.a];
-  }
-  return [false, defaultColor.r, defaultColor.g, defaultColor.b, defaultColor.a];
+const mutations = new MutationBuffer();
+let flushScheduled = false;
+
+// Ops issued outside a commit (e.g. passive-effect deletions) are flushed on the next microtask.
+const scheduleFlush = () => {
+  if (flushScheduled) return;
+  flushScheduled = true;
+  Promise.resolve().then(() => {
+    flushScheduled = false;
+    mutations.flush();
+  });
 };
 
 // Extract event handlers from props
@@ -81,184 +94,164 @@ const textWrapToNative = (wrap: PropsByType["vita-text"]["wrap"]): number => {
   return wrap === "word" ? 1 : 0;
 };
 
-const textLayoutArgs = (p: PropsByType["vita-text"]) =>
-  [
-    p.x ?? 8,
-    p.y ?? 8,
-    p.width ?? 0,
-    p.lineHeight ?? 0,
-    textAlignToNative(p.align),
-    textWrapToNative(p.wrap),
-  ] as const;
+const { I32, Bool, F32, Color: ColorField, String: StringField } = FieldKind;
+
+// Field layouts per node type; must match the PropField tables in src/jslib/instance.c
+const FIELD_LAYOUTS = {
+  "vita-rect": [I32, I32, I32, I32, Bool, Bool, ColorField, ColorField, F32],
+  "vita-text": [StringField, I32, Bool, ColorField, Bool, I32, I32, I32, I32, I32, I32],
+  "vita-button": [I32, I32, I32, I32, ColorField, StringField, I32, F32, ColorField],
+  "vita-scroll": [I32, I32, I32, I32, Bool, ColorField, I32, I32],
+  "vita-image": [StringField, I32, I32, I32, I32],
+} satisfies Record<Type, FieldKindValue[]>;
+
+const RAW_TEXT_LAYOUT: FieldKindValue[] = [StringField];
+
+const NODE_TYPES: Record<Type, number> = {
+  "vita-rect": NodeType.Rect,
+  "vita-text": NodeType.Text,
+  "vita-button": NodeType.Button,
+  "vita-scroll": NodeType.Scroll,
+  "vita-image": NodeType.Image,
+};
+
+// Image name and requested size are resolved together natively, so they always travel together
+const IMAGE_LAYOUT_FIELDS = (1 << 0) | (1 << 3) | (1 << 4);
 
-// Create native instance based on type
-const createNativeInstance = (id: string, type: Type, props: Props): void => {
+const flag = (value: boolean): number => (value ? 1 : 0);
+
+// Flatten props into the field values of FIELD_LAYOUTS[type]
+const encodeFields = (type: Type, props: Props): FieldValue[] => {
   if (type === "vita-rect") {
     const p = props as PropsByType["vita-rect"];
     const hasFill = p.variant !== "outline" && !!p.color;
     const hasOutline = !!p.borderColor || (p.variant === "outline" && !!p.color);
     const fillColor = hasFill && p.color ? p.color : Colors.BLANK;
     const outlineColor = p.borderColor ?? (hasOutline && p.color ? p.color : Colors.DARKGRAY);
-
-    nativeCreateRect(
-      id,
+    return [
       p.x,
       p.y,
       p.width,
       p.height,
-      hasFill,
-      fillColor.r,
-      fillColor.g,
-      fillColor.b,
-      fillColor.a,
-      hasOutline,
-      outlineColor.r,
-      outlineColor.g,
-      outlineColor.b,
-      outlineColor.a,
+      flag(hasFill),
+      flag(hasOutline),
+      packColor(fillColor),
+      packColor(outlineColor),
       p.borderRadius ?? 0,
-    );
-    registerHandlers(id, extractHandlers(props));
-  } else if (type === "vita-text") {
+    ];
+  }
+  if (type === "vita-text") {
     const p = props as PropsByType["vita-text"];
-    const [hasColor, r, g, b, a] = colorToArgs(p.color, Colors.BLACK);
-    const [tx, ty, tw, tlh, talign, twrap] = textLayoutArgs(p);
-    nativeCreateText(
-      id,
+    return [
       p.font ?? "default",
       p.fontSize ?? 30,
-      hasColor,
-      r,
-      g,
-      b,
-      a,
-      p.border ?? false,
-      tx,
-      ty,
-      tw,
-      tlh,
-      talign,
-      twrap,
-    );
-  } else if (type === "vita-button") {
+      flag(!!p.color),
+      packColor(p.color ?? Colors.BLACK),
+      flag(p.border ?? false),
+      p.x ?? 8,
+      p.y ?? 8,
+      p.width ?? 0,
+      p.lineHeight ?? 0,
+      textAlignToNative(p.align),
+      textWrapToNative(p.wrap),
+    ];
+  }
+  if (type === "vita-button") {
     const p = props as PropsByType["vita-button"];
-    const color = p.color ?? Colors.DARKBLUE;
-    const textColor = p.textColor ?? Colors.RAYWHITE;
-    nativeCreateButton(
-      id,
+    return [
       p.x,
       p.y,
       p.width,
       p.height,
-      color.r,
-      color.g,
-      color.b,
-      color.a,
+      packColor(p.color ?? Colors.DARKBLUE),
       p.label,
       20,
       p.borderRadius ?? 0,
-      textColor.r,
-      textColor.g,
-      textColor.b,
-      textColor.a,
-    );
-    registerHandlers(id, extractHandlers(props));
-  } else if (type === "vita-scroll") {
+      packColor(p.textColor ?? Colors.RAYWHITE),
+    ];
+  }
+  if (type === "vita-scroll") {
     const p = props as PropsByType["vita-scroll"];
-    const [hasFill, r, g, b, a] = colorToArgs(p.color, Colors.BLANK);
-    nativeCreateScroll(id, p.x, p.y, p.width, p.height, hasFill, r, g, b, a, p.gap ?? 0, p.padding ?? 0);
-  } else if (type === "vita-image") {
+    return [
+      p.x,
+      p.y,
+      p.width,
+      p.height,
+      flag(!!p.color),
+      packColor(p.color ?? Colors.BLANK),
+      p.gap ?? 0,
+      p.padding ?? 0,
+    ];
+  }
+  if (type === "vita-image") {
     const p = props as PropsByType["vita-image"];
-    nativeCreateImage(id, p.image, p.x, p.y, p.width ?? 0, p.height ?? 0);
-  } else {
-    exhaustiveGuard(type, `Unsupported element type: ${String(type)}`);
+    return [p.image, p.x, p.y, p.width ?? 0, p.height ?? 0];
   }
+  return exhaustiveGuard(type, `Unsupported element type: ${String(type)}`);
 };
 
-// Update native instance based on type
-const updateNativeInstance = (id: string, type: Type, props: Props): void => {
-  if (type === "vita-rect") {
-    const p = props as PropsByType["vita-rect"];
-    const hasFill = p.variant !== "outline" && !!p.color;
-    const hasOutline = !!p.borderColor || (p.variant === "outline" && !!p.color);
-    const fillColor = hasFill && p.color ? p.color : Colors.BLANK;
-    const outlineColor = p.borderColor ?? (hasOutline && p.color ? p.color : Colors.DARKGRAY);
+// Bitmask of the fields that differ between two encodings of the same type
+const diffFields = (type: Type, prev: FieldValue[], next: FieldValue[]): number => {
+  let mask = 0;
+  for (let i = 0; i < next.length; i++) {
+    if (prev[i] !== next[i]) mask |= 1 << i;
+  }
+  if (type === "vita-image" && mask & IMAGE_LAYOUT_FIELDS) mask |= IMAGE_LAYOUT_FIELDS;
+  return mask;
+};
 
-    nativeUpdateRect(
-      id,
-      p.x,
-      p.y,
-      p.width,
-      p.height,
-      hasFill,
-      fillColor.r,
-      fillColor.g,
-      fillColor.b,
-      fillColor.a,
-      hasOutline,
-      outlineColor.r,
-      outlineColor.g,
-      outlineColor.b,
-      outlineColor.a,
-      p.borderRadius ?? 0,
-    );
-    updateHandlers(id, extractHandlers(props));
-  } else if (type === "vita-text") {
-    const p = props as PropsByType["vita-text"];
-    const [hasColor, r, g, b, a] = colorToArgs(p.color, Colors.BLACK);
-    const [tx, ty, tw, tlh, talign, twrap] = textLayoutArgs(p);
-    nativeUpdateText(
-      id,
-      p.font ?? "default",
-      p.fontSize ?? 30,
-      hasColor,
-      r,
-      g,
-      b,
-      a,
-      p.border ?? false,
-      tx,
-      ty,
-      tw,
-      tlh,
-      talign,
-      twrap,
-    );
-  } else if (type === "vita-button") {
-    const p = props as PropsByType["vita-button"];
-    const color = p.color ?? Colors.DARKBLUE;
-    const textColor = p.textColor ?? Colors.RAYWHITE;
-    nativeUpdateButton(
-      id,
-      p.x,
-      p.y,
-      p.width,
-      p.height,
-      color.r,
-      color.g,
-      color.b,
-      color.a,
-      p.label,
-      20,
-      p.borderRadius ?? 0,
-      textColor.r,
-      textColor.g,
-      textColor.b,
-      textColor.a,
-    );
+const hasHandlers = (type: Type) => type === "vita-rect" || type === "vita-button";
+
+const handlersChanged = (oldProps: Props, newProps: Props): boolean => {
+  const prev = extractHandlers(oldProps);
+  const next = extractHandlers(newProps);
+  return prev.onPress !== next.onPress || prev.onPressStart !== next.onPressStart || prev.onPressEnd !== next.onPressEnd;
+};
+
+// Create native instance based on type
+const createNativeInstance = (id: number, type: Type, props: Props): void => {
+  mutations
+    .op(MutationOp.Create)
+    .u32(id)
+    .u32(NODE_TYPES[type])
+    .fields(FIELD_LAYOUTS[type], encodeFields(type, props), ALL_FIELDS);
+  if (hasHandlers(type)) {
+    registerHandlers(id, extractHandlers(props));
+  }
+};
+
+// Send only the fields recorded in the update payload
+const updateNativeInstance = (id: number, type: Type, payload: NonNullable<UpdatePayload>, props: Props): void => {
+  if (payload.mask !== 0) {
+    mutations
+      .op(MutationOp.Update)
+      .u32(id)
+      .u32(NODE_TYPES[type])
+      .u32(payload.mask)
+      .fields(FIELD_LAYOUTS[type], payload.fields, payload.mask);
+  }
+  if (hasHandlers(type)) {
     updateHandlers(id, extractHandlers(props));
-  } else if (type === "vita-scroll") {
-    const p = props as PropsByType["vita-scroll"];
-    const [hasFill, r, g, b, a] = colorToArgs(p.color, Colors.BLANK);
-    nativeUpdateScroll(id, p.x, p.y, p.width, p.height, hasFill, r, g, b, a, p.gap ?? 0, p.padding ?? 0);
-  } else if (type === "vita-image") {
-    const p = props as PropsByType["vita-image"];
-    nativeUpdateImage(id, p.image, p.x, p.y, p.width ?? 0, p.height ?? 0);
-  } else {
-    exhaustiveGuard(type, `Unsupported element type: ${String(type)}`);
   }
 };
 
+// react-reconciler calls detachDeletedInstance only for host components, never for text. A text
+// instance is destroyed when it is removed itself, or with the host instance it belongs to.
+const trackTextChild = (parent: Instance, child: Instance | TextInstance): void => {
+  if (child.type === "RawText") (parent.texts ??= new Set()).add(child);
+};
+
+const destroyText = (text: TextInstance): void => {
+  mutations.op(MutationOp.Destroy).u32(text.id);
+  releaseHandle(text.id);
+};
+
+const destroyTextChildren = (instance: Instance): void => {
+  if (!instance.texts) return;
+  for (const text of instance.texts) destroyText(text);
+  instance.texts = undefined;
+};
+
 const rawHostConfig = {
   noTimeout: -1,
   isPrimaryRenderer: true,
@@ -279,6 +272,8 @@ const rawHostConfig = {
 
   resetAfterCommit: (_container: Container) => {
     logReconcilerFunction("resetAfterCommit");
+    mutations.flush();
+    nativeCommit();
   },
 
   getChildHostContext: (..._args) => {
@@ -293,21 +288,22 @@ const rawHostConfig = {
 
   createTextInstance(text, _rootContainerInstance, _hostContext) {
     logReconcilerFunction("createTextInstance", text);
-    const id = generateInstanceId();
-    nativeCreateRawText(id, text);
+    const id = allocateHandle();
+    mutations.op(MutationOp.Create).u32(id).u32(NodeType.RawText).fields(RAW_TEXT_LAYOUT, [text], ALL_FIELDS);
     return { id, type: "RawText" } satisfies TextInstance;
   },
 
   createInstance(type, props: Props, _rootContainerInstance, _hostContext) {
     logReconcilerFunction("createInstance", type);
-    const id = generateInstanceId();
+    const id = allocateHandle();
     createNativeInstance(id, type, props);
     return { id, type } satisfies Instance;
   },
 
   appendInitialChild(parentInstance, child) {
     logReconcilerFunction("appendInitialChild");
-    nativeAppendChild(parentInstance.id, child.id);
+    mutations.op(MutationOp.AppendChild).u32(parentInstance.id).u32(child.id);
+    trackTextChild(parentInstance, child);
   },
 
   finalizeInitialChildren(_instance, type) {
@@ -317,52 +313,53 @@ const rawHostConfig = {
 
   prepareUpdate(_instance, type, oldProps, newProps, _rootContainerInstance, _hostContext) {
     logReconcilerFunction("prepareUpdate", type);
-    const changes = {
-      props: [] as string[],
-    };
-    const keys = Object.keys({ ...oldProps, ...newProps });
-    for (const key of keys) {
-      if ((oldProps as Record<string, unknown>)[key] !== (newProps as Record<string, unknown>)[key]) {
-        changes.props.push(key);
-      }
-    }
-    return changes.props.length > 0 ? { props: changes.props } : null;
+    const fields = encodeFields(type, newProps);
+    const mask = diffFields(type, encodeFields(type, oldProps), fields);
+    if (mask === 0 && !(hasHandlers(type) && handlersChanged(oldProps, newProps))) return null;
+    return { mask, fields };
   },
 
   appendChild(parentInstance, child) {
     logReconcilerFunction("appendChild");
-    nativeAppendChild(parentInstance.id, child.id);
+    mutations.op(MutationOp.AppendChild).u32(parentInstance.id).u32(child.id);
+    trackTextChild(parentInstance, child);
   },
 
   appendChildToContainer(_container, child) {
     logReconcilerFunction("appendChildToContainer");
-    // Empty string for parentId means root container
-    nativeAppendChild("", child.id);
+    // The root handle stands for the root container
+    mutations.op(MutationOp.AppendChild).u32(ROOT_HANDLE).u32(child.id);
   },
 
   insertBefore(parentInstance, child, beforeChild) {
     logReconcilerFunction("insertBefore");
-    nativeInsertBefore(parentInstance.id, child.id, beforeChild.id);
+    mutations.op(MutationOp.InsertBefore).u32(parentInstance.id).u32(child.id).u32(beforeChild.id);
+    trackTextChild(parentInstance, child);
   },
 
   insertInContainerBefore(_container, child, beforeChild) {
     logReconcilerFunction("insertInContainerBefore");
-    nativeInsertBefore("", child.id, beforeChild.id);
+    mutations.op(MutationOp.InsertBefore).u32(ROOT_HANDLE).u32(child.id).u32(beforeChild.id);
   },
 
   removeChild(parentInstance, child) {
     logReconcilerFunction("removeChild");
-    nativeRemoveChild(parentInstance.id, child.id);
+    mutations.op(MutationOp.RemoveChild).u32(parentInstance.id).u32(child.id);
+    if (child.type === "RawText") {
+      parentInstance.texts?.delete(child);
+      destroyText(child);
+    }
   },
 
   removeChildFromContainer(_container, child) {
     logReconcilerFunction("removeChildFromContainer");
-    nativeRemoveChild("", child.id);
+    mutations.op(MutationOp.RemoveChild).u32(ROOT_HANDLE).u32(child.id);
+    if (child.type === "RawText") destroyText(child);
   },
 
   commitTextUpdate(textInstance, _oldText, newText) {
     logReconcilerFunction("commitTextUpdate", newText);
-    nativeUpdateRawText(textInstance.id, newText);
+    mutations.op(MutationOp.Update).u32(textInstance.id).u32(NodeType.RawText).u32(1).string(newText);
   },
 
   resetTextContent(_instance) {
@@ -370,14 +367,14 @@ const rawHostConfig = {
     // Text content is managed via children, no action needed
   },
 
-  commitUpdate(instance, _updatePayload, type, _prevProps, nextProps: Props, _internalInstanceHandle) {
+  commitUpdate(instance, updatePayload, type, _prevProps, nextProps: Props, _internalInstanceHandle) {
     logReconcilerFunction("commitUpdate", type);
-    updateNativeInstance(instance.id, type, nextProps);
+    if (updatePayload) updateNativeInstance(instance.id, type, updatePayload, nextProps);
   },
 
   clearContainer(_container) {
     logReconcilerFunction("clearContainer");
-    nativeClearContainer();
+    mutations.op(MutationOp.ClearContainer);
   },
 
   commitMount(_instance, type) {
@@ -387,7 +384,10 @@ const rawHostConfig = {
   detachDeletedInstance(instance) {
     logReconcilerFunction("detachDeletedInstance");
     unregisterHandlers(instance.id);
-    nativeDestroyInstance(instance.id);
+    destroyTextChildren(instance);
+    mutations.op(MutationOp.Destroy).u32(instance.id);
+    releaseHandle(instance.id);
+    scheduleFlush();
   },
 } satisfies Partial<VitadeckHostConfig>;
 
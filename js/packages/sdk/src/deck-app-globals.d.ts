@@ -11,6 +11,25 @@ interface VitaRequestInit {
   method?: string;
   headers?: VitaHeadersInit;
   body?: string;
+  // Settle as soon as the body starts and read it in chunks through `response.body`.
+  stream?: boolean;
+}
+
+type VitaReadResult = { done: false; value: Uint8Array } | { done: true; value: undefined };
+
+interface VitaStreamReader {
+  read(): Promise<VitaReadResult>;
+  cancel(): Promise<void>;
+  releaseLock(): void;
+}
+
+// The subset of ReadableStream that Deck Apps need. Chunks are the body bytes as received; decode
+// them with a streaming TextDecoder, since a chunk can end inside a multi-byte character.
+interface VitaReadableStream {
+  readonly locked: boolean;
+  getReader(): VitaStreamReader;
+  cancel(): Promise<void>;
+  [Symbol.asyncIterator](): AsyncIterator<Uint8Array>;
 }
 
 interface VitaResponse {
@@ -18,12 +37,22 @@ interface VitaResponse {
   readonly ok: boolean;
   readonly statusText: string;
   readonly headers: Record<string, string>;
+  readonly body: VitaReadableStream;
+  readonly bodyUsed: boolean;
+  arrayBuffer(): Promise<ArrayBuffer>;
   text(): Promise<string>;
   json<T = unknown>(): Promise<T>;
 }
 
 function fetch(url: string, init?: VitaRequestInit): Promise<VitaResponse>;
 
+// UTF-8 only.
+declare class TextDecoder {
+  constructor(label?: string);
+  readonly encoding: string;
+  decode(input?: ArrayBuffer | ArrayBufferView, options?: { stream?: boolean }): string;
+}
+
 declare var console: {
   log: (...args: unknown[]) => void;
   info: (...args: unknown[]) => void;
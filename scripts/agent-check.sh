@@ -57,7 +57,7 @@ run_host() {
     cmake --build out --parallel
 
     step "Run non-smoke CTest"
-    ctest --test-dir out --output-on-failure -E smoke_harness
+    ctest --test-dir out --output-on-failure -E "smoke_harness|bench_harness|perf_gate"
 }
 
 run_smoke_tests() {
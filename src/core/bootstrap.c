@@ -4,6 +4,9 @@
 #include <stdio.h>
 
 #include "core/event_queue.h"
+#include "core/latency.h"
+#include "core/perf.h"
+#include "core/profiler.h"
 #include "core/package_library.h"
 #include "ui/fonts.h"
 #include "ui/images.h"
@@ -40,6 +43,11 @@ bool bootstrap_boot_subsystems(char *error, size_t error_size)
         return false;
     }
 
+    if (!latency_init() || !perf_init() || !prof_init()) {
+        if (error && error_size > 0) snprintf(error, error_size, "Could not initialize performance tracing.");
+        return false;
+    }
+
     instance_tree_init();
 
     if (!package_library_init(error, error_size)) return false;
@@ -113,6 +121,9 @@ void bootstrap_shutdown(VdBootstrap *bootstrap)
     font_registry_shutdown();
     event_queue_shutdown();
     event_queue_destroy();
+    latency_destroy();
+    perf_destroy();
+    prof_destroy();
     if (bootstrap->window_open) {
         CloseWindow();
         bootstrap->window_open = false;
@@ -1,91 +1,118 @@
 #include "event_queue.h"
 #include "platform/thread.h"
-#include <string.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 
+// Power of two so the free-running indices wrap cleanly.
 #define QUEUE_CAPACITY 256
 
+// Single-producer (UI thread) / single-consumer (JS thread) ring. head is only written by
+// the consumer and tail only by the producer; release/acquire on them publishes the slots.
 typedef struct {
     InputEvent events[QUEUE_CAPACITY];
-    int head;
-    int tail;
-    int count;
-    bool shutdown;
-    vd_mutex *mutex;
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint dropped;
+    atomic_bool shutdown;
+    vd_event *wakeup;
 } EventQueue;
 
 static EventQueue queue;
 
 bool event_queue_init(void)
 {
-    queue.head = 0;
-    queue.tail = 0;
-    queue.count = 0;
-    queue.shutdown = false;
-    queue.mutex = vd_mutex_create();
-    return queue.mutex != NULL;
+    atomic_init(&queue.head, 0);
+    atomic_init(&queue.tail, 0);
+    atomic_init(&queue.dropped, 0);
+    atomic_init(&queue.shutdown, false);
+    queue.wakeup = vd_event_create();
+    return queue.wakeup != NULL;
 }
 
 void event_queue_destroy(void)
 {
-    if (queue.mutex) {
-        vd_mutex_destroy(queue.mutex);
-        queue.mutex = NULL;
+    if (queue.wakeup) {
+        vd_event_destroy(queue.wakeup);
+        queue.wakeup = NULL;
+    }
+}
+
+static void event_queue_put(const InputEvent *evt)
+{
+    unsigned int tail = atomic_load_explicit(&queue.tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&queue.head, memory_order_acquire);
+
+    if (tail - head < QUEUE_CAPACITY) {
+        queue.events[tail % QUEUE_CAPACITY] = *evt;
+        atomic_store_explicit(&queue.tail, tail + 1, memory_order_release);
+    } else {
+        atomic_fetch_add_explicit(&queue.dropped, 1, memory_order_relaxed);
     }
 }
 
 void event_queue_push(const InputEvent *evt)
 {
-    vd_mutex_lock(queue.mutex);
+    event_queue_put(evt);
+    vd_event_signal(queue.wakeup);
+}
 
-    if (queue.count < QUEUE_CAPACITY) {
-        memcpy(&queue.events[queue.tail], evt, sizeof(InputEvent));
-        queue.tail = (queue.tail + 1) % QUEUE_CAPACITY;
-        queue.count++;
+void event_queue_push_many(const InputEvent *evts, int count)
+{
+    if (count <= 0) return;
+    for (int i = 0; i < count; i++) {
+        event_queue_put(&evts[i]);
     }
-
-    vd_mutex_unlock(queue.mutex);
+    vd_event_signal(queue.wakeup);
 }
 
 bool event_queue_pop(InputEvent *evt)
 {
-    bool got_event = false;
-
-    vd_mutex_lock(queue.mutex);
+    unsigned int head = atomic_load_explicit(&queue.head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue.tail, memory_order_acquire);
+    if (head == tail) return false;
 
-    if (queue.count > 0) {
-        memcpy(evt, &queue.events[queue.head], sizeof(InputEvent));
-        queue.head = (queue.head + 1) % QUEUE_CAPACITY;
-        queue.count--;
-        got_event = true;
-    }
-
-    vd_mutex_unlock(queue.mutex);
+    *evt = queue.events[head % QUEUE_CAPACITY];
+    atomic_store_explicit(&queue.head, head + 1, memory_order_release);
+    return true;
+}
 
-    return got_event;
+unsigned int event_queue_take_dropped(void)
+{
+    return atomic_exchange_explicit(&queue.dropped, 0, memory_order_relaxed);
 }
 
 void event_queue_shutdown(void)
 {
-    vd_mutex_lock(queue.mutex);
-    queue.shutdown = true;
-    vd_mutex_unlock(queue.mutex);
+    atomic_store(&queue.shutdown, true);
+    vd_event_signal(queue.wakeup);
 }
 
 bool event_queue_is_shutdown(void)
 {
-    bool shutdown;
-    vd_mutex_lock(queue.mutex);
-    shutdown = queue.shutdown;
-    vd_mutex_unlock(queue.mutex);
-    return shutdown;
+    return atomic_load(&queue.shutdown);
 }
 
 void event_queue_clear(void)
 {
-    vd_mutex_lock(queue.mutex);
-    queue.head = 0;
-    queue.tail = 0;
-    queue.count = 0;
-    vd_mutex_unlock(queue.mutex);
+    atomic_store(&queue.head, 0);
+    atomic_store(&queue.tail, 0);
+    atomic_store(&queue.dropped, 0);
+}
+
+static bool event_queue_ready(void)
+{
+    return atomic_load_explicit(&queue.head, memory_order_relaxed) !=
+               atomic_load_explicit(&queue.tail, memory_order_acquire) ||
+           atomic_load(&queue.shutdown);
+}
+
+void event_queue_wait(int timeout_ms)
+{
+    if (event_queue_ready()) return;
+    vd_event_wait(queue.wakeup, timeout_ms);
+}
+
+void event_queue_wake(void)
+{
+    vd_event_signal(queue.wakeup);
 }
@@ -2,21 +2,40 @@
 #define EVENT_QUEUE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef enum { EVT_INPUT, EVT_SHUTDOWN } EventType;
 
+typedef enum { INPUT_MOUSEENTER, INPUT_MOUSELEAVE, INPUT_MOUSEDOWN, INPUT_MOUSEUP, INPUT_CLICK } InputEventKind;
+
 typedef struct {
     EventType type;
-    char id[64];
-    char event_name[32];
+    InputEventKind kind;
+    uint32_t target; // InstanceHandle of the instance the event is for
+    double time;     // GetTime() seconds when the UI thread observed the input
 } InputEvent;
 
 bool event_queue_init(void);
 void event_queue_destroy(void);
+
+// Lock-free single-producer/single-consumer ring: push from the UI thread only, pop from the
+// JS thread only. A push into a full ring is counted instead of queued.
 void event_queue_push(const InputEvent *evt);
+// Push count events and wake the consumer once.
+void event_queue_push_many(const InputEvent *evts, int count);
 bool event_queue_pop(InputEvent *evt);
+// Number of events dropped because the ring was full since the last call (resets the count).
+unsigned int event_queue_take_dropped(void);
+
 void event_queue_shutdown(void);
 bool event_queue_is_shutdown(void);
+// Only while the JS thread is not running.
 void event_queue_clear(void);
 
+// Block the consumer until an event is pushed, event_queue_wake() is called, the queue
+// shuts down, or timeout_ms elapses (< 0 waits forever). Returns immediately if events are queued.
+void event_queue_wait(int timeout_ms);
+// Wake a consumer blocked in event_queue_wait (e.g. when async work completes). Thread-safe.
+void event_queue_wake(void);
+
 #endif /* EVENT_QUEUE_H */
@@ -5,11 +5,16 @@
 #include <stdlib.h>
 #include "quickjs.h"
 #include "core/event_queue.h"
+#include "core/perf.h"
+#include "core/profiler.h"
 #include "jslib/jslib.h"
 #include "platform/thread.h"
 #include "ui/input.h"
 #include "ui/instance_tree.h"
 
+// Upper bound on one idle wait, as a safety net for wakeups that are not signaled.
+#define JS_LOOP_MAX_WAIT_MS 250
+
 static int run_function(JSContext *ctx, const char *func_name)
 {
     JSValue global = JS_GetGlobalObject(ctx);
@@ -102,8 +107,10 @@ static void *js_thread_func(void *arg)
         goto defer;
     }
 
+    double zone = prof_begin();
     JSValue eval_result = JS_Eval(ctx, code, len, "runtime.js", JS_EVAL_TYPE_GLOBAL);
     free(code);
+    prof_end(PROF_THREAD_JS, "eval runtime.js", zone);
 
     if (JS_IsException(eval_result)) {
         JSValue exc = JS_GetException(ctx);
@@ -117,6 +124,7 @@ static void *js_thread_func(void *arg)
     }
     JS_FreeValue(ctx, eval_result);
 
+    zone = prof_begin();
     if (run_function(ctx, "updateContainer") != 0) {
         runtime->failed = true;
         goto defer;
@@ -124,18 +132,37 @@ static void *js_thread_func(void *arg)
 
     drain_microtasks(rt);
     instance_tree_swap();
+    prof_end(PROF_THREAD_JS, "initial render", zone);
     runtime->ready = true;
 
     while (!runtime->stop_requested && !event_queue_is_shutdown()) {
+        double phase = perf_begin();
         process_input_events(ctx);
+        perf_end(PERF_JS_INPUT, phase);
+
+        phase = perf_begin();
         run_timeouts(ctx);
+        perf_end(PERF_JS_TIMERS, phase);
+
+        phase = perf_begin();
         run_fetch(ctx);
+        perf_end(PERF_JS_FETCH, phase);
+
+        phase = perf_begin();
         drain_microtasks(rt);
+        perf_end(PERF_JS_MICROTASKS, phase);
+
+        phase = perf_begin();
         instance_tree_swap();
-        vd_thread_yield();
+        perf_end(PERF_JS_SWAP, phase);
+        perf_js_iteration_end();
+
+        // Sleep until the next timer is due or input / a fetch completion / stop wakes us.
+        event_queue_wait(timeout_next_delay_ms(JS_LOOP_MAX_WAIT_MS));
     }
 
 defer:
+    if (ctx) input_events_shutdown(ctx);
     if (ctx) timeout_shutdown(ctx);
     if (ctx) fetch_shutdown(ctx);
     if (ctx) JS_FreeContext(ctx);
@@ -157,8 +184,8 @@ bool js_runtime_start(VdJsRuntime *runtime)
     runtime->stop_requested = false;
     runtime->ready = false;
     runtime->failed = false;
+    input_reset();
     event_queue_clear();
-    input_clear_focus();
     runtime->thread = vd_thread_create(js_thread_func, runtime);
     return runtime->thread != NULL;
 }
@@ -167,11 +194,12 @@ void js_runtime_stop(VdJsRuntime *runtime)
 {
     if (!runtime->thread) return;
     runtime->stop_requested = true;
+    event_queue_wake();
     vd_thread_join((vd_thread *)runtime->thread);
     vd_thread_destroy((vd_thread *)runtime->thread);
     runtime->thread = NULL;
     runtime->ready = false;
-    input_clear_focus();
+    input_reset();
     instance_tree_clear();
     event_queue_clear();
 }
@@ -0,0 +1,225 @@
+#include "latency.h"
+
+#include <raylib.h>
+#include <string.h>
+#include "platform/thread.h"
+
+// 1 ms buckets; the last one collects everything slower.
+#define LATENCY_BUCKETS 250
+// A press whose handlers caused no commit within this long is dropped rather than
+// attributed to an unrelated later render.
+#define LATENCY_COMMIT_TIMEOUT 0.5
+
+typedef struct {
+    double captured_at;
+    double dequeued_at;
+    double dispatched_at;
+    double committed_at;
+    double published_at;
+    unsigned int generation;
+} LatencyTrace;
+
+typedef struct {
+    int buckets[LATENCY_BUCKETS];
+    int count;
+    double sum_ms;
+    double max_ms;
+} LatencyHistogram;
+
+// JS thread only.
+static LatencyTrace pending;
+static bool pending_active = false;
+static bool pending_dispatched = false;
+static bool pending_committed = false;
+
+// UI thread only.
+static unsigned int rendered_generation = 0;
+
+// Shared, guarded by latency_mutex.
+static vd_mutex *latency_mutex = NULL;
+static LatencyTrace published;
+static bool published_active = false;
+static LatencyHistogram histograms[LATENCY_STAGE_COUNT];
+
+bool latency_init(void)
+{
+    if (!latency_mutex) latency_mutex = vd_mutex_create();
+    return latency_mutex != NULL;
+}
+
+void latency_destroy(void)
+{
+    if (latency_mutex) {
+        vd_mutex_destroy(latency_mutex);
+        latency_mutex = NULL;
+    }
+}
+
+void latency_input_begin(double captured_at, double dequeued_at)
+{
+    if (pending_active && (!pending_dispatched || GetTime() - pending.dispatched_at < LATENCY_COMMIT_TIMEOUT)) {
+        return; // fold into the press already in flight
+    }
+    pending = (LatencyTrace){.captured_at = captured_at, .dequeued_at = dequeued_at};
+    pending_active = true;
+    pending_dispatched = false;
+    pending_committed = false;
+}
+
+void latency_input_end(void)
+{
+    if (!pending_active || pending_dispatched) return;
+    pending.dispatched_at = GetTime();
+    pending_dispatched = true;
+    // A commit inside the handlers (flushSync) counts as part of the dispatch.
+    if (pending_committed && pending.committed_at < pending.dispatched_at) {
+        pending.committed_at = pending.dispatched_at;
+    }
+}
+
+void latency_committed(void)
+{
+    if (!pending_active || pending_committed) return;
+    double now = GetTime();
+    if (pending_dispatched && now - pending.dispatched_at >= LATENCY_COMMIT_TIMEOUT) {
+        pending_active = false;
+        return;
+    }
+    pending.committed_at = now;
+    pending_committed = true;
+}
+
+void latency_published(unsigned int front_generation)
+{
+    if (!pending_active || !pending_dispatched || !pending_committed) return;
+    pending.published_at = GetTime();
+    pending.generation = front_generation;
+    pending_active = false;
+
+    vd_mutex_lock(latency_mutex);
+    if (!published_active) {
+        published = pending;
+        published_active = true;
+    }
+    vd_mutex_unlock(latency_mutex);
+}
+
+void latency_rendered(unsigned int front_generation)
+{
+    rendered_generation = front_generation;
+}
+
+static void histogram_add(LatencyHistogram *h, double seconds)
+{
+    double ms = seconds * 1000.0;
+    if (ms < 0.0) ms = 0.0;
+    int bucket = (int)ms;
+    if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+    h->buckets[bucket]++;
+    h->count++;
+    h->sum_ms += ms;
+    if (ms > h->max_ms) h->max_ms = ms;
+}
+
+void latency_presented(void)
+{
+    vd_mutex_lock(latency_mutex);
+    if (published_active && (int)(rendered_generation - published.generation) >= 0) {
+        double presented_at = GetTime();
+        const LatencyTrace *t = &published;
+        histogram_add(&histograms[LATENCY_QUEUE], t->dequeued_at - t->captured_at);
+        histogram_add(&histograms[LATENCY_DISPATCH], t->dispatched_at - t->dequeued_at);
+        histogram_add(&histograms[LATENCY_COMMIT], t->committed_at - t->dispatched_at);
+        histogram_add(&histograms[LATENCY_PUBLISH], t->published_at - t->committed_at);
+        histogram_add(&histograms[LATENCY_PRESENT], presented_at - t->published_at);
+        histogram_add(&histograms[LATENCY_TOTAL], presented_at - t->captured_at);
+        published_active = false;
+    }
+    vd_mutex_unlock(latency_mutex);
+}
+
+const char *latency_stage_name(LatencyStage stage)
+{
+    switch (stage) {
+    case LATENCY_QUEUE:
+        return "queue";
+    case LATENCY_DISPATCH:
+        return "dispatch";
+    case LATENCY_COMMIT:
+        return "commit";
+    case LATENCY_PUBLISH:
+        return "publish";
+    case LATENCY_PRESENT:
+        return "present";
+    case LATENCY_TOTAL:
+        return "total";
+    case LATENCY_STAGE_COUNT:
+        break;
+    }
+    return "unknown";
+}
+
+static double histogram_percentile(const LatencyHistogram *h, double q)
+{
+    int target = (int)(q * h->count + 0.999);
+    if (target < 1) target = 1;
+    int seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS - 1; i++) {
+        seen += h->buckets[i];
+        if (seen >= target) return (double)(i + 1) < h->max_ms ? (double)(i + 1) : h->max_ms;
+    }
+    return h->max_ms;
+}
+
+void latency_get_stats(LatencyStage stage, LatencyStats *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (stage < 0 || stage >= LATENCY_STAGE_COUNT) return;
+
+    vd_mutex_lock(latency_mutex);
+    const LatencyHistogram *h = &histograms[stage];
+    if (h->count > 0) {
+        out->count = h->count;
+        out->mean_ms = h->sum_ms / h->count;
+        out->p50_ms = histogram_percentile(h, 0.50);
+        out->p95_ms = histogram_percentile(h, 0.95);
+        out->p99_ms = histogram_percentile(h, 0.99);
+        out->max_ms = h->max_ms;
+    }
+    vd_mutex_unlock(latency_mutex);
+}
+
+void latency_reset(void)
+{
+    vd_mutex_lock(latency_mutex);
+    memset(histograms, 0, sizeof(histograms));
+    published_active = false;
+    vd_mutex_unlock(latency_mutex);
+}
+
+void latency_draw_overlay(int x, int y)
+{
+    static const char *columns[] = {"n", "p50", "p95", "p99", "max"};
+    const int font_size = 16;
+    const int row_h = font_size + 4;
+    const int value_x = x + 90;
+    const int column_w = 48;
+
+    DrawRectangle(x, y, 90 + column_w * 5 + 8, row_h * (LATENCY_STAGE_COUNT + 1) + 8, (Color){0, 0, 0, 180});
+    DrawText("latency ms", x + 6, y + 4, font_size, RAYWHITE);
+    for (int c = 0; c < 5; c++) {
+        DrawText(columns[c], value_x + c * column_w, y + 4, font_size, RAYWHITE);
+    }
+
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        LatencyStats stats;
+        latency_get_stats((LatencyStage)stage, &stats);
+        double values[5] = {stats.count, stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.max_ms};
+        int row_y = y + 4 + row_h * (stage + 1);
+        Color color = stage == LATENCY_TOTAL ? YELLOW : LIGHTGRAY;
+        DrawText(latency_stage_name((LatencyStage)stage), x + 6, row_y, font_size, color);
+        for (int c = 0; c < 5; c++) {
+            DrawText(TextFormat("%.0f", values[c]), value_x + c * column_w, row_y, font_size, color);
+        }
+    }
+}
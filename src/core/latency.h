@@ -0,0 +1,53 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdbool.h>
+
+// Input-to-photon latency tracing. A press is stamped when the UI thread captures it and
+// followed through the JS thread (dequeue, handlers, React commit, publish) to the
+// EndDrawing of the first frame that shows the published snapshot. One press is traced
+// at a time; presses that arrive while one is in flight fold into it.
+
+typedef enum {
+    LATENCY_QUEUE,    // capture -> dequeued by the JS thread
+    LATENCY_DISPATCH, // dequeue -> JS input handlers returned
+    LATENCY_COMMIT,   // handlers -> React commit
+    LATENCY_PUBLISH,  // commit -> instance_tree_swap publish
+    LATENCY_PRESENT,  // publish -> EndDrawing of the first frame showing it
+    LATENCY_TOTAL,    // capture -> present
+    LATENCY_STAGE_COUNT
+} LatencyStage;
+
+typedef struct {
+    int count;
+    double mean_ms;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+} LatencyStats;
+
+bool latency_init(void);
+void latency_destroy(void);
+
+// JS thread. begin/end bracket the dispatch of a batch whose oldest press was captured at
+// captured_at; committed and published are called from instance_tree_commit/swap.
+void latency_input_begin(double captured_at, double dequeued_at);
+void latency_input_end(void);
+void latency_committed(void);
+void latency_published(unsigned int front_generation);
+
+// UI thread. rendered is called (under the render lock) with the generation being drawn,
+// presented right after EndDrawing.
+void latency_rendered(unsigned int front_generation);
+void latency_presented(void);
+
+// Thread-safe.
+const char *latency_stage_name(LatencyStage stage);
+void latency_get_stats(LatencyStage stage, LatencyStats *out);
+void latency_reset(void);
+
+// Draw the per-stage table with its top-left corner at (x, y) (UI thread).
+void latency_draw_overlay(int x, int y);
+
+#endif /* LATENCY_H */
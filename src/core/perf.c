@@ -0,0 +1,222 @@
+#include "perf.h"
+
+#include <raylib.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "core/latency.h"
+#include "core/profiler.h"
+#include "platform/thread.h"
+
+// Rolling window per metric, about two seconds of frames at 60 FPS.
+#define PERF_WINDOW 120
+#define PERF_UI_FIRST PERF_UI_INPUT
+#define PERF_JS_FIRST PERF_JS_INPUT
+
+typedef struct {
+    float samples[PERF_WINDOW];
+    int next;
+    int count;
+} PerfRing;
+
+static atomic_bool enabled;
+
+// Accumulators for the frame / iteration in progress. UI metrics are only touched by the UI
+// thread and JS metrics by the JS thread.
+static double current[PERF_METRIC_COUNT];
+static double ui_frame_start = 0.0;
+
+// UI rings are UI-thread only; JS rings are written by the JS thread and read by the HUD
+// under perf_mutex.
+static PerfRing rings[PERF_METRIC_COUNT];
+static vd_mutex *perf_mutex = NULL;
+
+static const char *metric_names[PERF_METRIC_COUNT] = {
+    [PERF_UI_INPUT] = "input",
+    [PERF_UI_LOCK_WAIT] = "lock wait",
+    [PERF_UI_RENDER] = "render",
+    [PERF_UI_SHELL] = "shell",
+    [PERF_UI_PRESENT] = "present",
+    [PERF_UI_FRAME] = "frame",
+    [PERF_JS_INPUT] = "input",
+    [PERF_JS_TIMERS] = "timers",
+    [PERF_JS_FETCH] = "fetch",
+    [PERF_JS_MICROTASKS] = "microtasks",
+    [PERF_JS_SWAP] = "swap",
+    [PERF_JS_LOOP] = "loop",
+};
+
+bool perf_init(void)
+{
+    atomic_init(&enabled, false);
+    if (!perf_mutex) perf_mutex = vd_mutex_create();
+    return perf_mutex != NULL;
+}
+
+void perf_destroy(void)
+{
+    if (perf_mutex) {
+        vd_mutex_destroy(perf_mutex);
+        perf_mutex = NULL;
+    }
+}
+
+void perf_set_enabled(bool value)
+{
+    if (value == atomic_load_explicit(&enabled, memory_order_relaxed)) return;
+    if (value) {
+        vd_mutex_lock(perf_mutex);
+        memset(rings, 0, sizeof(rings));
+        vd_mutex_unlock(perf_mutex);
+        ui_frame_start = 0.0;
+    }
+    atomic_store_explicit(&enabled, value, memory_order_relaxed);
+}
+
+bool perf_enabled(void)
+{
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+double perf_begin(void)
+{
+    return perf_enabled() || prof_capturing() ? GetTime() : 0.0;
+}
+
+void perf_end(PerfMetric metric, double start)
+{
+    if (start <= 0.0) return;
+    double elapsed = GetTime() - start;
+    if (perf_enabled()) current[metric] += elapsed;
+    prof_zone(metric < PERF_JS_FIRST ? PROF_THREAD_UI : PROF_THREAD_JS, 0, metric_names[metric], start, elapsed);
+}
+
+static void ring_push(PerfRing *ring, double seconds)
+{
+    ring->samples[ring->next] = (float)(seconds * 1000.0);
+    ring->next = (ring->next + 1) % PERF_WINDOW;
+    if (ring->count < PERF_WINDOW) ring->count++;
+}
+
+void perf_ui_frame_end(void)
+{
+    if (!perf_enabled()) return;
+
+    double now = GetTime();
+    if (ui_frame_start > 0.0) current[PERF_UI_FRAME] = now - ui_frame_start;
+    ui_frame_start = now;
+
+    for (int m = PERF_UI_FIRST; m < PERF_JS_FIRST; m++) {
+        ring_push(&rings[m], current[m]);
+        current[m] = 0.0;
+    }
+}
+
+void perf_js_iteration_end(void)
+{
+    if (!perf_enabled()) return;
+
+    // Loop time is the busy part of the iteration: the phases measured since the last end.
+    current[PERF_JS_LOOP] = 0.0;
+    for (int m = PERF_JS_FIRST; m < PERF_JS_LOOP; m++) {
+        current[PERF_JS_LOOP] += current[m];
+    }
+
+    vd_mutex_lock(perf_mutex);
+    for (int m = PERF_JS_FIRST; m < PERF_METRIC_COUNT; m++) {
+        ring_push(&rings[m], current[m]);
+    }
+    vd_mutex_unlock(perf_mutex);
+
+    for (int m = PERF_JS_FIRST; m < PERF_METRIC_COUNT; m++) {
+        current[m] = 0.0;
+    }
+}
+
+static int compare_floats(const void *a, const void *b)
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// p50/p95/p99 of a ring (caller holds perf_mutex for JS rings).
+static void ring_percentiles(const PerfRing *ring, float out[3])
+{
+    out[0] = out[1] = out[2] = 0.0f;
+    if (ring->count == 0) return;
+
+    float sorted[PERF_WINDOW];
+    memcpy(sorted, ring->samples, (size_t)ring->count * sizeof(float));
+    qsort(sorted, (size_t)ring->count, sizeof(float), compare_floats);
+    out[0] = sorted[(ring->count - 1) * 50 / 100];
+    out[1] = sorted[(ring->count - 1) * 95 / 100];
+    out[2] = sorted[(ring->count - 1) * 99 / 100];
+}
+
+static int draw_section(const char *title, int first, int last, int x, int y)
+{
+    const int font_size = 16;
+    const int row_h = font_size + 4;
+    const int value_x = x + 90;
+    const int column_w = 60;
+
+    DrawText(title, x + 6, y, font_size, RAYWHITE);
+    DrawText("p50", value_x, y, font_size, RAYWHITE);
+    DrawText("p95", value_x + column_w, y, font_size, RAYWHITE);
+    DrawText("p99", value_x + column_w * 2, y, font_size, RAYWHITE);
+    y += row_h;
+
+    for (int m = first; m <= last; m++) {
+        float p[3];
+        ring_percentiles(&rings[m], p);
+        Color color = m == last ? YELLOW : LIGHTGRAY;
+        DrawText(metric_names[m], x + 6, y, font_size, color);
+        for (int c = 0; c < 3; c++) {
+            DrawText(TextFormat("%.1f", p[c]), value_x + c * column_w, y, font_size, color);
+        }
+        y += row_h;
+    }
+    return y;
+}
+
+// Frame times, oldest on the left; the line marks the 60 FPS budget.
+static int draw_frame_graph(int x, int y, int width, int height)
+{
+    const float budget_ms = 1000.0f / 60.0f;
+    const float scale_ms = budget_ms * 3.0f;
+    const PerfRing *ring = &rings[PERF_UI_FRAME];
+    float bar_w = (float)width / PERF_WINDOW;
+
+    for (int i = 0; i < ring->count; i++) {
+        int index = (ring->next - ring->count + i + PERF_WINDOW) % PERF_WINDOW;
+        float ms = ring->samples[index];
+        float h = ms / scale_ms * height;
+        if (h > height) h = (float)height;
+        Color color = ms > budget_ms * 1.5f ? RED : ms > budget_ms * 1.1f ? ORANGE : GREEN;
+        DrawRectangleRec((Rectangle){x + i * bar_w, y + height - h, bar_w, h}, color);
+    }
+    int budget_y = y + height - (int)(budget_ms / scale_ms * height);
+    DrawLine(x, budget_y, x + width, budget_y, (Color){255, 255, 255, 120});
+    return y + height;
+}
+
+void perf_hud_draw(int x, int y)
+{
+    const int width = 338;
+    const int ui_rows = PERF_UI_FRAME - PERF_UI_FIRST + 2;
+    const int js_rows = PERF_JS_LOOP - PERF_JS_FIRST + 2;
+    const int graph_h = 48;
+
+    DrawRectangle(x, y, width, (ui_rows + js_rows) * 20 + graph_h + 24, (Color){0, 0, 0, 180});
+    DrawText(TextFormat("%d FPS", GetFPS()), x + width - 70, y + 4, 16, GREEN);
+
+    int row_y = draw_section("UI ms", PERF_UI_FIRST, PERF_UI_FRAME, x, y + 4);
+    row_y = draw_frame_graph(x + 6, row_y + 2, width - 12, graph_h) + 8;
+
+    vd_mutex_lock(perf_mutex);
+    row_y = draw_section("JS ms", PERF_JS_FIRST, PERF_JS_LOOP, x, row_y);
+    vd_mutex_unlock(perf_mutex);
+
+    latency_draw_overlay(x, row_y + 8);
+}
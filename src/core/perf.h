@@ -0,0 +1,46 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdbool.h>
+
+// Per-frame (UI thread) and per-loop-iteration (JS thread) phase timings for the performance
+// HUD. Nothing is measured while the HUD is disabled: perf_begin() returns 0 and perf_end()
+// returns immediately. During a profiler capture each phase is also recorded as a zone.
+
+typedef enum {
+    // UI thread, one sample per frame
+    PERF_UI_INPUT,
+    PERF_UI_LOCK_WAIT,
+    PERF_UI_RENDER,
+    PERF_UI_SHELL,
+    PERF_UI_PRESENT,
+    PERF_UI_FRAME,
+    // JS thread, one sample per loop iteration (excluding the idle wait)
+    PERF_JS_INPUT,
+    PERF_JS_TIMERS,
+    PERF_JS_FETCH,
+    PERF_JS_MICROTASKS,
+    PERF_JS_SWAP,
+    PERF_JS_LOOP,
+    PERF_METRIC_COUNT
+} PerfMetric;
+
+bool perf_init(void);
+void perf_destroy(void);
+
+void perf_set_enabled(bool enabled);
+bool perf_enabled(void);
+
+// Start time for perf_end(), or 0 when disabled.
+double perf_begin(void);
+// Add the time since start to metric in the current frame / iteration.
+void perf_end(PerfMetric metric, double start);
+
+// Close the current UI frame / JS loop iteration and record its samples.
+void perf_ui_frame_end(void);
+void perf_js_iteration_end(void);
+
+// Draw the HUD with its top-left corner at (x, y) (UI thread).
+void perf_hud_draw(int x, int y);
+
+#endif /* PERF_H */
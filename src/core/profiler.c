@@ -0,0 +1,247 @@
+#include "profiler.h"
+
+#include <raylib.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "stb_ds.h"
+#include "platform/thread.h"
+
+// Zones kept per thread; the oldest are overwritten once a ring is full.
+#define PROF_RING_CAPACITY 8192
+#define PROF_LANE_STRIDE 1000
+
+#ifdef __vita__
+#define PROF_DEFAULT_PATH "ux0:data/vitadeck/profile.json"
+#else
+#define PROF_DEFAULT_PATH "vitadeck-data/profile.json"
+#endif
+
+typedef struct {
+    const char *name;
+    double start;
+    double duration;
+    int lane;
+} ProfEvent;
+
+typedef struct {
+    vd_mutex *mutex;
+    ProfEvent *events; // PROF_RING_CAPACITY entries while capturing, NULL otherwise
+    int next;
+    int count;
+} ProfRing;
+
+typedef struct {
+    char *key;
+    bool value;
+} ProfName;
+
+typedef struct {
+    int key;
+    bool value;
+} ProfTid;
+
+static atomic_bool capturing;
+static double capture_start = 0.0;
+static ProfRing rings[PROF_THREAD_COUNT];
+static ProfName *names = NULL;
+
+static const char *thread_names[PROF_THREAD_COUNT] = {
+    [PROF_THREAD_UI] = "UI",
+    [PROF_THREAD_JS] = "JS",
+    [PROF_THREAD_FETCH] = "fetch",
+    [PROF_THREAD_UPLOAD] = "upload",
+};
+
+bool prof_init(void)
+{
+    atomic_init(&capturing, false);
+    for (int t = 0; t < PROF_THREAD_COUNT; t++) {
+        if (!rings[t].mutex) rings[t].mutex = vd_mutex_create();
+        if (!rings[t].mutex) return false;
+    }
+    return true;
+}
+
+void prof_destroy(void)
+{
+    atomic_store(&capturing, false);
+    for (int t = 0; t < PROF_THREAD_COUNT; t++) {
+        free(rings[t].events);
+        rings[t].events = NULL;
+        if (rings[t].mutex) vd_mutex_destroy(rings[t].mutex);
+        rings[t].mutex = NULL;
+    }
+    shfree(names);
+    names = NULL;
+}
+
+bool prof_start(void)
+{
+    for (int t = 0; t < PROF_THREAD_COUNT; t++) {
+        ProfRing *ring = &rings[t];
+        vd_mutex_lock(ring->mutex);
+        if (!ring->events) ring->events = malloc(sizeof(ProfEvent) * PROF_RING_CAPACITY);
+        ring->next = 0;
+        ring->count = 0;
+        bool ok = ring->events != NULL;
+        vd_mutex_unlock(ring->mutex);
+        if (!ok) {
+            TraceLog(LOG_ERROR, "Profiler: could not allocate the capture buffers.");
+            return false;
+        }
+    }
+    capture_start = GetTime();
+    atomic_store(&capturing, true);
+    return true;
+}
+
+bool prof_capturing(void)
+{
+    return atomic_load_explicit(&capturing, memory_order_relaxed);
+}
+
+const char *prof_default_path(void)
+{
+    return PROF_DEFAULT_PATH;
+}
+
+double prof_begin(void)
+{
+    return prof_capturing() ? GetTime() : 0.0;
+}
+
+void prof_zone(ProfThread thread, int lane, const char *name, double start, double duration)
+{
+    if (start <= 0.0 || !prof_capturing()) return;
+    ProfRing *ring = &rings[thread];
+    vd_mutex_lock(ring->mutex);
+    if (ring->events) {
+        ring->events[ring->next] = (ProfEvent){name, start, duration, lane};
+        ring->next = (ring->next + 1) % PROF_RING_CAPACITY;
+        if (ring->count < PROF_RING_CAPACITY) ring->count++;
+    }
+    vd_mutex_unlock(ring->mutex);
+}
+
+void prof_end_lane(ProfThread thread, int lane, const char *name, double start)
+{
+    if (start <= 0.0 || !prof_capturing()) return;
+    prof_zone(thread, lane, name, start, GetTime() - start);
+}
+
+void prof_end(ProfThread thread, const char *name, double start)
+{
+    prof_end_lane(thread, 0, name, start);
+}
+
+const char *prof_intern(const char *name)
+{
+    if (!names) sh_new_strdup(names);
+    ptrdiff_t index = shgeti(names, name);
+    if (index < 0) {
+        shput(names, name, true);
+        index = shgeti(names, name);
+    }
+    return names[index].key;
+}
+
+static void write_json_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(f, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static void write_thread_name(FILE *f, ProfThread thread, int lane)
+{
+    char name[32];
+    if (lane == 0) {
+        snprintf(name, sizeof(name), "%s", thread_names[thread]);
+    } else {
+        snprintf(name, sizeof(name), "%s %d", thread_names[thread], lane);
+    }
+    fprintf(f, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+            thread * PROF_LANE_STRIDE + lane);
+    write_json_string(f, name);
+    fputs("}}", f);
+}
+
+// Write the zones of every ring, oldest first per thread, with a thread_name record for each
+// (thread, lane) row that appears.
+static void write_trace(FILE *f, ProfEvent **events, const int *counts, const int *firsts)
+{
+    ProfTid *seen = NULL;
+
+    fputs("{\"traceEvents\":[", f);
+    fputs("\n{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"VitaDeck\"}}", f);
+
+    for (int t = 0; t < PROF_THREAD_COUNT; t++) {
+        for (int i = 0; i < counts[t]; i++) {
+            const ProfEvent *e = &events[t][(firsts[t] + i) % PROF_RING_CAPACITY];
+            if (e->start < capture_start) continue;
+            int lane = e->lane % PROF_LANE_STRIDE;
+            int tid = t * PROF_LANE_STRIDE + lane;
+            if (hmgeti(seen, tid) < 0) {
+                hmput(seen, tid, true);
+                write_thread_name(f, (ProfThread)t, lane);
+            }
+            fprintf(f, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":", tid,
+                    (e->start - capture_start) * 1e6, e->duration * 1e6);
+            write_json_string(f, e->name ? e->name : "?");
+            fputc('}', f);
+        }
+    }
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+    hmfree(seen);
+}
+
+bool prof_stop(const char *path, char *error, size_t error_size)
+{
+    if (!prof_capturing()) {
+        if (error && error_size > 0) snprintf(error, error_size, "No profile capture is running.");
+        return false;
+    }
+    atomic_store(&capturing, false);
+
+    // Detach the rings so zones finishing on other threads while the file is written are dropped.
+    ProfEvent *events[PROF_THREAD_COUNT];
+    int counts[PROF_THREAD_COUNT];
+    int firsts[PROF_THREAD_COUNT];
+    for (int t = 0; t < PROF_THREAD_COUNT; t++) {
+        ProfRing *ring = &rings[t];
+        vd_mutex_lock(ring->mutex);
+        events[t] = ring->events;
+        counts[t] = ring->count;
+        firsts[t] = (ring->next - ring->count + PROF_RING_CAPACITY) % PROF_RING_CAPACITY;
+        ring->events = NULL;
+        ring->next = 0;
+        ring->count = 0;
+        vd_mutex_unlock(ring->mutex);
+    }
+
+    if (!path) path = PROF_DEFAULT_PATH;
+    FILE *f = fopen(path, "w");
+    bool ok = f != NULL;
+    if (f) {
+        write_trace(f, events, counts, firsts);
+        ok = ferror(f) == 0;
+        if (fclose(f) != 0) ok = false;
+    }
+    if (!ok && error && error_size > 0) snprintf(error, error_size, "Could not write profile to %s.", path);
+
+    for (int t = 0; t < PROF_THREAD_COUNT; t++) {
+        free(events[t]);
+    }
+    return ok;
+}
@@ -0,0 +1,46 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Cross-thread zone profiler. While a capture is running, every completed zone is appended to
+// the ring of the thread that ran it; prof_stop() writes the captured zones as Chrome trace
+// JSON (chrome://tracing, Perfetto). Outside a capture prof_begin() returns 0 and prof_end()
+// returns immediately.
+//
+// There is no thread-local storage in the platform layer, so callers name their thread. Work that
+// runs concurrently passes a lane to get a row of its own in the trace: the single fetch worker
+// uses one lane per concurrent transfer slot, and the upload server one per connection.
+
+typedef enum {
+    PROF_THREAD_UI,
+    PROF_THREAD_JS,
+    PROF_THREAD_FETCH,
+    PROF_THREAD_UPLOAD,
+    PROF_THREAD_COUNT
+} ProfThread;
+
+bool prof_init(void);
+void prof_destroy(void);
+
+// Start a capture, dropping anything left from the previous one. Returns false when the rings
+// could not be allocated.
+bool prof_start(void);
+// End the capture and write it to path, or to prof_default_path() when path is NULL.
+bool prof_stop(const char *path, char *error, size_t error_size);
+bool prof_capturing(void);
+const char *prof_default_path(void);
+
+// Start time for prof_end(), or 0 when not capturing.
+double prof_begin(void);
+// Record a zone from start to now. name must outlive the capture (a literal or prof_intern()).
+void prof_end(ProfThread thread, const char *name, double start);
+void prof_end_lane(ProfThread thread, int lane, const char *name, double start);
+// Record a zone measured elsewhere; start and duration are in seconds on the GetTime() clock.
+void prof_zone(ProfThread thread, int lane, const char *name, double start, double duration);
+
+// Stable copy of a zone name, kept until prof_destroy() (JS thread).
+const char *prof_intern(const char *name);
+
+#endif /* PROFILER_H */
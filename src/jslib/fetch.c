@@ -1,12 +1,26 @@
 /*
-        Minimal fetch() backed by libcurl. Each request runs on its own worker
-        thread so the JS event loop never blocks; completed requests are polled by
-        run_fetch() on the JS thread, which resolves/rejects the JS Promise.
+        Minimal fetch() backed by libcurl. A single network worker thread drives
+        every request through one curl_multi handle, at most FETCH_MAX_CONCURRENT
+        at a time, so the JS event loop never blocks. Connections, DNS results
+        and TLS sessions are reused across the requests of one Deck App, and
+        plain GETs go through the on-disk HTTP cache (http_cache.h) first.
+        Streaming requests hand their body to JS in chunks (nativeFetchRead) and
+        pause the transfer while FETCH_STREAM_HIGH_WATER bytes are unread; collecting the
+        stream handle cancels a transfer JS dropped. Finished requests go on a
+        completion queue and wake the JS thread; run_fetch() drains it there and
+        resolves/rejects the JS Promises.
 */
 #include "jslib_internal.h"
 #include <ctype.h>
+#include <stdatomic.h>
+#include <strings.h>
+#include <time.h>
 #include <curl/curl.h>
 #include "arena.h"
+#include "core/event_queue.h"
+#include "core/package_library.h"
+#include "core/profiler.h"
+#include "http_cache.h"
 #include "platform/thread.h"
 
 typedef struct {
@@ -34,33 +48,139 @@ typedef struct {
     bool failed;
     char error[CURL_ERROR_SIZE];
 
-    bool done;
-    vd_thread *thread;
+    bool cacheable;    // a plain GET that may be answered from or stored in the HTTP cache
+    bool revalidating; // sent with the validators of a stale cache entry
+
+    // Network worker only, while the request is attached to the multi handle.
+    CURL *easy;
+    int slot;
+    double zone;
+
+    // Streaming mode: the promise settles once the body starts and the body is read in chunks.
+    bool streaming;
+    int stream_id;
+    bool response_sent; // JS thread
+    bool released;      // JS thread: the JS side is done with the stream
+    JSValue read_resolve;
+    JSValue read_reject; // JS_UNDEFINED unless a nativeFetchRead is pending
+
+    // Guarded by fetch_mutex.
+    char *stream_data; // stb_ds array of body bytes not yet read by JS
+    bool headers_ready;
+    bool stream_paused;
+    bool resume_requested;
+    bool cancel_requested;
+    bool worker_done;
+    bool update_queued;
 
     JSValue resolve;
     JSValue reject;
 } FetchRequest;
 
-static FetchRequest **fetch_pending = NULL;
+typedef struct {
+    int key;
+    FetchRequest *value;
+} FetchStream;
+
+// Transfers the network worker runs at once; further requests wait in fetch_submitted.
+#define FETCH_MAX_CONCURRENT 4
+// Upper bound on one curl_multi_poll, as a safety net for wakeups that are not signaled.
+#define FETCH_MAX_WAIT_MS 1000
+// Largest Content-Length the body buffer is allocated for up front.
+#define FETCH_PRESIZE_MAX (16 * 1024 * 1024)
+// Size budget of the on-disk HTTP cache (response bodies).
+#define FETCH_CACHE_MAX_BYTES (8 * 1024 * 1024)
+// A streaming transfer pauses once this many bytes wait for JS to read them.
+#define FETCH_STREAM_HIGH_WATER (64 * 1024)
+
+// Guarded by fetch_mutex. JS thread -> worker: fetch_submitted. Worker -> JS thread: fetch_updates
+// (requests that finished, or streaming requests with new body data).
+static FetchRequest **fetch_submitted = NULL;
+static FetchRequest **fetch_updates = NULL;
+static bool fetch_stop_requested = false;
 static vd_mutex *fetch_mutex = NULL;
+// Lets run_fetch skip the lock on loop iterations where nothing happened.
+static atomic_bool fetch_has_updates;
+// Streaming responses handed to JS, by stream id (JS thread only).
+static FetchStream *fetch_streams = NULL;
+static int fetch_next_stream_id = 0;
+// JS holds a stream as an object of this class; finalizing it releases a stream JS dropped unread.
+static JSClassID fetch_stream_class_id = 0;
+
+// Worker lifetime is one JS runtime: started by the first fetch, joined by fetch_shutdown.
+static vd_thread *fetch_thread = NULL;
+static CURLM *fetch_multi = NULL;
+// DNS and TLS session caches shared by every transfer of the Deck App, and easy handles kept
+// between transfers so their connections stay alive for the next request to the same host.
+// Both are only touched by the network worker, so the share needs no lock callbacks.
+static CURLSH *fetch_share = NULL;
+static CURL **fetch_idle_handles = NULL;
 
 static void buffer_append(Arena *arena, FetchBuffer *buf, const char *data, size_t len)
 {
     arena_da_append_many(arena, buf, data, len);
 }
 
+// Queue req for run_fetch unless it is already queued. Caller holds fetch_mutex.
+static void fetch_queue_update_locked(FetchRequest *req)
+{
+    if (req->update_queued) return;
+    req->update_queued = true;
+    arrput(fetch_updates, req);
+}
+
+static void fetch_signal_updates(void)
+{
+    atomic_store(&fetch_has_updates, true);
+    event_queue_wake();
+}
+
 static size_t fetch_write_cb(char *ptr, size_t size, size_t nmemb, void *userdata)
 {
     FetchRequest *req = userdata;
     size_t total = size * nmemb;
-    buffer_append(&req->response_body, &req->resp_body, ptr, total);
-    return total;
+    if (!req->streaming) {
+        // The body arena ends up owned by the JS ArrayBuffer: size it once from Content-Length
+        // instead of leaving the doubling steps behind.
+        if (req->resp_body.capacity == 0) {
+            curl_off_t length = -1;
+            curl_easy_getinfo(req->easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+            if (length > 0 && length <= FETCH_PRESIZE_MAX) {
+                req->resp_body.items = arena_alloc(&req->response_body, (size_t)length);
+                req->resp_body.capacity = req->resp_body.items ? (size_t)length : 0;
+            }
+        }
+        buffer_append(&req->response_body, &req->resp_body, ptr, total);
+        return total;
+    }
+
+    long status = 0;
+    if (!req->headers_ready) curl_easy_getinfo(req->easy, CURLINFO_RESPONSE_CODE, &status);
+
+    vd_mutex_lock(fetch_mutex);
+    // Paused data is not consumed: curl delivers it again after curl_easy_pause(CURLPAUSE_CONT).
+    bool pause = arrlen(req->stream_data) >= FETCH_STREAM_HIGH_WATER;
+    if (pause) {
+        req->stream_paused = true;
+    } else {
+        memcpy(arraddnptr(req->stream_data, total), ptr, total);
+    }
+    if (!req->headers_ready) {
+        req->status = status;
+        req->headers_ready = true;
+    }
+    fetch_queue_update_locked(req);
+    vd_mutex_unlock(fetch_mutex);
+    fetch_signal_updates();
+    return pause ? CURL_WRITEFUNC_PAUSE : total;
 }
 
 static size_t fetch_header_cb(char *buffer, size_t size, size_t nitems, void *userdata)
 {
     FetchRequest *req = userdata;
     size_t total = size * nitems;
+    // Trailers of a streaming response would race with JS reading the headers: drop them.
+    if (req->streaming && req->headers_ready) return total;
 
     if (total >= 5 && strncmp(buffer, "HTTP/", 5) == 0) {
         arena_rewind(&req->response_headers, req->header_mark);
@@ -82,48 +202,328 @@ static size_t fetch_header_cb(char *buffer, size_t size, size_t nitems, void *us
     return total;
 }
 
-static void *fetch_worker(void *arg)
+// Create the easy handle for req and attach it to the multi handle in profiler lane slot + 1.
+static bool fetch_attach(FetchRequest *req, int slot)
 {
-    FetchRequest *req = arg;
+    req->zone = prof_begin();
+    req->slot = slot;
     req->header_mark = arena_snapshot(&req->response_headers);
 
-    CURL *curl = curl_easy_init();
+    CURL *curl = NULL;
+    if (arrlen(fetch_idle_handles) > 0) {
+        curl = arrpop(fetch_idle_handles);
+        curl_easy_reset(curl);
+    } else {
+        curl = curl_easy_init();
+    }
     if (!curl) {
         req->failed = true;
         snprintf(req->error, sizeof(req->error), "Failed to initialize curl");
+        return false;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, req->url);
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, req->method);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    if (req->streaming) {
+        // Streams may stay open indefinitely (server-sent events), so only bound the connect.
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
     } else {
-        curl_easy_setopt(curl, CURLOPT_URL, req->url);
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, req->method);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, "vitadeck/1.0");
-        curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, req->error);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, fetch_write_cb);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, req);
-        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, fetch_header_cb);
-        curl_easy_setopt(curl, CURLOPT_HEADERDATA, req);
-        if (req->headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, req->headers);
-        if (req->body) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, req->body);
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)req->body_len);
+    }
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_SHARE, fetch_share);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "vitadeck/1.0");
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, req->error);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, fetch_write_cb);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, req);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, fetch_header_cb);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, req);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, req);
+    if (req->headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, req->headers);
+    if (req->body) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, req->body);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)req->body_len);
+    }
+
+    if (curl_multi_add_handle(fetch_multi, curl) != CURLM_OK) {
+        curl_easy_cleanup(curl);
+        req->failed = true;
+        snprintf(req->error, sizeof(req->error), "Failed to start transfer");
+        return false;
+    }
+    req->easy = curl;
+    return true;
+}
+
+// Detach req from the multi handle and record the transfer result.
+static void fetch_detach(FetchRequest *req, CURLcode res)
+{
+    if (res != CURLE_OK) {
+        req->failed = true;
+        if (req->error[0] == '\0') {
+            snprintf(req->error, sizeof(req->error), "%s", curl_easy_strerror(res));
         }
+    } else if (!req->headers_ready) {
+        curl_easy_getinfo(req->easy, CURLINFO_RESPONSE_CODE, &req->status);
+    }
+    curl_multi_remove_handle(fetch_multi, req->easy);
+    if (arrlen(fetch_idle_handles) < FETCH_MAX_CONCURRENT) {
+        arrput(fetch_idle_handles, req->easy);
+    } else {
+        curl_easy_cleanup(req->easy);
+    }
+    req->easy = NULL;
+    prof_end_lane(PROF_THREAD_FETCH, req->slot + 1, "fetch", req->zone);
+}
 
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK) {
-            req->failed = true;
-            if (req->error[0] == '\0') {
-                snprintf(req->error, sizeof(req->error), "%s", curl_easy_strerror(res));
-            }
+static void fetch_complete(FetchRequest *req)
+{
+    vd_mutex_lock(fetch_mutex);
+    req->worker_done = true;
+    fetch_queue_update_locked(req);
+    vd_mutex_unlock(fetch_mutex);
+    fetch_signal_updates();
+}
+
+// Replace req's response with the one stored in the HTTP cache.
+static bool fetch_cache_serve(FetchRequest *req)
+{
+    HttpCacheResponse cached;
+    if (!http_cache_load(req->url, &cached)) return false;
+    req->status = cached.status;
+    req->status_line = arena_strdup(&req->response_headers, cached.status_line);
+    req->resp_headers = (FetchBuffer){0};
+    buffer_append(&req->response_headers, &req->resp_headers, cached.headers, cached.headers_size);
+    req->resp_body = (FetchBuffer){0};
+    buffer_append(&req->response_body, &req->resp_body, cached.body, cached.body_size);
+    http_cache_response_free(&cached);
+    return true;
+}
+
+// Before a cacheable request goes out: answer it from a fresh cache entry (returns true), or
+// turn it into a conditional request when the entry is stale.
+static bool fetch_cache_begin(FetchRequest *req)
+{
+    HttpCacheValidators validators;
+    HttpCacheLookup lookup = http_cache_lookup(req->url, time(NULL), &validators);
+    if (lookup == HTTP_CACHE_FRESH) {
+        double zone = prof_begin();
+        bool served = fetch_cache_serve(req);
+        prof_end(PROF_THREAD_FETCH, "fetch cache hit", zone);
+        return served;
+    }
+    if (lookup == HTTP_CACHE_STALE) {
+        char header[HTTP_CACHE_ETAG_MAX + 32];
+        if (validators.etag[0]) {
+            snprintf(header, sizeof(header), "If-None-Match: %s", validators.etag);
+            req->headers = curl_slist_append(req->headers, header);
+        }
+        if (validators.last_modified[0]) {
+            snprintf(header, sizeof(header), "If-Modified-Since: %s", validators.last_modified);
+            req->headers = curl_slist_append(req->headers, header);
+        }
+        req->revalidating = true;
+    }
+    return false;
+}
+
+// Turn a revalidation back into a plain request: drop the validators fetch_cache_begin added
+// (a cacheable request has none of its own) and the 304 it got.
+static void fetch_cache_unrevalidate(FetchRequest *req)
+{
+    struct curl_slist **link = &req->headers;
+    while (*link) {
+        struct curl_slist *h = *link;
+        if (strncasecmp(h->data, "if-none-match:", 14) == 0 || strncasecmp(h->data, "if-modified-since:", 18) == 0) {
+            *link = h->next;
+            h->next = NULL;
+            curl_slist_free_all(h);
         } else {
-            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &req->status);
+            link = &h->next;
         }
-        curl_easy_cleanup(curl);
+    }
+    req->revalidating = false;
+    req->status = 0;
+    req->status_line = NULL;
+    req->resp_headers = (FetchBuffer){0};
+    arena_free(&req->response_headers);
+    req->resp_body = (FetchBuffer){0};
+    arena_free(&req->response_body);
+}
+
+// After a cacheable transfer: a 304 to a revalidation is answered with the stored response,
+// and a 200 is offered to the cache. Returns true when the request has to go out again: the
+// stored response was evicted before its 304 arrived.
+static bool fetch_cache_finish(FetchRequest *req)
+{
+    if (req->failed) return false;
+    time_t now = time(NULL);
+    if (req->revalidating && req->status == 304) {
+        http_cache_refresh(req->url, now, req->resp_headers.items, req->resp_headers.count);
+        if (!fetch_cache_serve(req)) {
+            fetch_cache_unrevalidate(req);
+            return true;
+        }
+    } else if (req->status == 200) {
+        http_cache_store(req->url, now, req->status_line, req->resp_headers.items, req->resp_headers.count,
+                         req->resp_body.items, req->resp_body.count);
+    }
+    return false;
+}
+
+// The network worker: one thread drives every transfer through fetch_multi. It sleeps in
+// curl_multi_poll until a socket is ready or js_native_fetch / fetch_shutdown wakes it.
+static void *fetch_worker(void *arg)
+{
+    (void)arg;
+    FetchRequest *active[FETCH_MAX_CONCURRENT] = {0};
+    int running = 0;
+
+    char cache_dir[VD_PATH_MAX];
+    snprintf(cache_dir, sizeof(cache_dir), "%s/http-cache", package_library_root());
+    http_cache_open(cache_dir, FETCH_CACHE_MAX_BYTES);
+
+    for (;;) {
+        FetchRequest **starting = NULL;
+        FetchRequest *cancelling[FETCH_MAX_CONCURRENT];
+        FetchRequest *resuming[FETCH_MAX_CONCURRENT];
+        int cancel_count = 0;
+        int resume_count = 0;
+
+        vd_mutex_lock(fetch_mutex);
+        bool stop = fetch_stop_requested;
+        while (!stop && running + (int)arrlen(starting) < FETCH_MAX_CONCURRENT && arrlen(fetch_submitted) > 0) {
+            arrput(starting, fetch_submitted[0]);
+            arrdel(fetch_submitted, 0);
+        }
+        for (int i = 0; i < FETCH_MAX_CONCURRENT; i++) {
+            FetchRequest *req = active[i];
+            if (!req) continue;
+            if (req->cancel_requested) {
+                cancelling[cancel_count++] = req;
+            } else if (req->resume_requested) {
+                req->resume_requested = false;
+                req->stream_paused = false;
+                resuming[resume_count++] = req;
+            }
+        }
+        vd_mutex_unlock(fetch_mutex);
+        if (stop) break;
+
+        // Outside the lock: unpausing calls fetch_write_cb right away with the held-back data.
+        for (int i = 0; i < resume_count; i++) {
+            curl_easy_pause(resuming[i]->easy, CURLPAUSE_CONT);
+        }
+        for (int i = 0; i < cancel_count; i++) {
+            FetchRequest *req = cancelling[i];
+            active[req->slot] = NULL;
+            running--;
+            snprintf(req->error, sizeof(req->error), "fetch aborted");
+            fetch_detach(req, CURLE_ABORTED_BY_CALLBACK);
+            fetch_complete(req);
+        }
+
+        for (size_t i = 0; i < arrlen(starting); i++) {
+            if (starting[i]->cacheable && fetch_cache_begin(starting[i])) {
+                fetch_complete(starting[i]);
+                continue;
+            }
+            int slot = 0;
+            while (active[slot])
+                slot++;
+            if (fetch_attach(starting[i], slot)) {
+                active[slot] = starting[i];
+                running++;
+            } else {
+                fetch_complete(starting[i]);
+            }
+        }
+        arrfree(starting);
+
+        int still_running = 0;
+        curl_multi_perform(fetch_multi, &still_running);
+
+        CURLMsg *msg;
+        int msgs_left = 0;
+        while ((msg = curl_multi_info_read(fetch_multi, &msgs_left))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            FetchRequest *req = NULL;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&req);
+            CURLcode res = msg->data.result;
+            active[req->slot] = NULL;
+            running--;
+            fetch_detach(req, res);
+            if (req->cacheable && fetch_cache_finish(req)) {
+                // Back to the front of the queue; the next iteration sends it without validators.
+                vd_mutex_lock(fetch_mutex);
+                arrins(fetch_submitted, 0, req);
+                vd_mutex_unlock(fetch_mutex);
+                curl_multi_wakeup(fetch_multi);
+                continue;
+            }
+            fetch_complete(req);
+        }
+
+        curl_multi_poll(fetch_multi, NULL, 0, FETCH_MAX_WAIT_MS, NULL);
     }
 
+    // Shutting down: abandon transfers still in flight; fetch_shutdown frees them unsettled.
+    for (int i = 0; i < FETCH_MAX_CONCURRENT; i++) {
+        if (!active[i]) continue;
+        snprintf(active[i]->error, sizeof(active[i]->error), "fetch aborted");
+        fetch_detach(active[i], CURLE_ABORTED_BY_CALLBACK);
+        fetch_complete(active[i]);
+    }
+    http_cache_close();
+    return NULL;
+}
+
+static void fetch_engine_cleanup(void)
+{
+    for (size_t i = 0; i < arrlen(fetch_idle_handles); i++) {
+        curl_easy_cleanup(fetch_idle_handles[i]);
+    }
+    arrfree(fetch_idle_handles);
+    fetch_idle_handles = NULL;
+    if (fetch_multi) curl_multi_cleanup(fetch_multi);
+    fetch_multi = NULL;
+    // Last: the share must outlive every easy handle that uses it.
+    if (fetch_share) curl_share_cleanup(fetch_share);
+    fetch_share = NULL;
+}
+
+static bool fetch_engine_start(void)
+{
+    fetch_multi = curl_multi_init();
+    fetch_share = curl_share_init();
+    if (!fetch_multi || !fetch_share) {
+        fetch_engine_cleanup();
+        return false;
+    }
+    curl_share_setopt(fetch_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(fetch_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+    fetch_stop_requested = false;
+    fetch_thread = vd_thread_create(fetch_worker, NULL);
+    if (!fetch_thread) {
+        fetch_engine_cleanup();
+        return false;
+    }
+    return true;
+}
+
+static void fetch_engine_stop(void)
+{
+    if (!fetch_thread) return;
     vd_mutex_lock(fetch_mutex);
-    req->done = true;
+    fetch_stop_requested = true;
     vd_mutex_unlock(fetch_mutex);
-    return NULL;
+    curl_multi_wakeup(fetch_multi);
+    vd_thread_join(fetch_thread);
+    vd_thread_destroy(fetch_thread);
+    fetch_thread = NULL;
+    fetch_engine_cleanup();
 }
 
 static JSValue build_headers_object(JSContext *ctx, FetchRequest *req)
@@ -132,9 +532,11 @@ static JSValue build_headers_object(JSContext *ctx, FetchRequest *req)
     const char *p = req->resp_headers.items;
     if (!p) return headers;
 
-    while (*p) {
-        const char *line_end = strpbrk(p, "\r\n");
-        if (!line_end) line_end = p + strlen(p);
+    const char *end = p + req->resp_headers.count;
+    while (p < end) {
+        const char *line_end = p;
+        while (line_end < end && *line_end != '\r' && *line_end != '\n')
+            line_end++;
         size_t line_len = (size_t)(line_end - p);
 
         const char *colon = memchr(p, ':', line_len);
@@ -155,7 +557,7 @@ static JSValue build_headers_object(JSContext *ctx, FetchRequest *req)
         }
 
         p = line_end;
-        while (*p == '\r' || *p == '\n')
+        while (p < end && (*p == '\r' || *p == '\n'))
             p++;
     }
     return headers;
@@ -174,14 +576,79 @@ static const char *status_text_from_line(const char *status_line)
     return p;
 }
 
-static void resolve_fetch(JSContext *ctx, FetchRequest *req)
+static void settle_promise(JSContext *ctx, JSValueConst fn, JSValue arg)
+{
+    JSValue result = JS_Call(ctx, fn, JS_UNDEFINED, 1, &arg);
+    if (JS_IsException(result)) {
+        JSValue exc = JS_GetException(ctx);
+        const char *str = JS_ToCString(ctx, exc);
+        TraceLog(LOG_ERROR, "[fetch] error settling promise: %s", str ? str : "unknown");
+        JS_FreeCString(ctx, str);
+        JS_FreeValue(ctx, exc);
+    }
+    JS_FreeValue(ctx, result);
+    JS_FreeValue(ctx, arg);
+}
+
+static JSValue fetch_error(JSContext *ctx, FetchRequest *req)
+{
+    JSValue err = JS_NewError(ctx);
+    JS_SetPropertyStr(ctx, err, "message", JS_NewString(ctx, req->error[0] ? req->error : "fetch failed"));
+    return err;
+}
+
+static void free_body_arena(JSRuntime *rt, void *opaque, void *ptr)
+{
+    (void)rt;
+    (void)ptr;
+    arena_free(opaque);
+    free(opaque);
+}
+
+// An ArrayBuffer over the response body in place: the buffer adopts the body arena, which it
+// frees when collected. Text is only decoded if JS asks for it (nativeDecodeText).
+static JSValue take_body_buffer(JSContext *ctx, FetchRequest *req)
+{
+    Arena *arena = req->resp_body.items ? malloc(sizeof(Arena)) : NULL;
+    if (!arena) return JS_NewArrayBufferCopy(ctx, (const uint8_t *)req->resp_body.items, req->resp_body.count);
+
+    *arena = req->response_body;
+    JSValue buffer = JS_NewArrayBuffer(ctx, (uint8_t *)req->resp_body.items, req->resp_body.count, free_body_arena,
+                                       arena, false);
+    if (JS_IsException(buffer)) {
+        free(arena);
+        return buffer;
+    }
+    req->response_body = (Arena){0};
+    req->resp_body = (FetchBuffer){0};
+    return buffer;
+}
+
+// The object JS reads a stream through. It holds only the stream id, so it may outlive the stream.
+static JSValue new_stream_handle(JSContext *ctx, int stream_id)
+{
+    JSValue handle = JS_NewObjectClass(ctx, (int)fetch_stream_class_id);
+    if (!JS_IsException(handle)) JS_SetOpaque(handle, (void *)(intptr_t)stream_id);
+    return handle;
+}
+
+// The stream behind a handle, or NULL once it has ended or been released.
+static FetchRequest *stream_from_handle(JSValueConst handle)
+{
+    int stream_id = (int)(intptr_t)JS_GetOpaque(handle, fetch_stream_class_id);
+    if (stream_id == 0 || !fetch_streams) return NULL;
+    ptrdiff_t index = hmgeti(fetch_streams, stream_id);
+    return index < 0 ? NULL : fetch_streams[index].value;
+}
+
+// Settle the nativeFetch promise. A streaming response carries its stream handle instead of a body.
+static void resolve_fetch(JSContext *ctx, FetchRequest *req, bool failed)
 {
     JSValue arg;
     JSValue fn;
 
-    if (req->failed) {
-        arg = JS_NewError(ctx);
-        JS_SetPropertyStr(ctx, arg, "message", JS_NewString(ctx, req->error[0] ? req->error : "fetch failed"));
+    if (failed) {
+        arg = fetch_error(ctx, req);
         fn = req->reject;
     } else {
         JSValue resp = JS_NewObject(ctx);
@@ -189,31 +656,25 @@ static void resolve_fetch(JSContext *ctx, FetchRequest *req)
         JS_SetPropertyStr(ctx, resp, "ok", JS_NewBool(ctx, req->status >= 200 && req->status < 300));
         JS_SetPropertyStr(ctx, resp, "statusText", JS_NewString(ctx, status_text_from_line(req->status_line)));
         JS_SetPropertyStr(ctx, resp, "headers", build_headers_object(ctx, req));
-        if (req->resp_body.items) {
-            JS_SetPropertyStr(ctx, resp, "body", JS_NewStringLen(ctx, req->resp_body.items, req->resp_body.count));
+        if (req->streaming) {
+            JS_SetPropertyStr(ctx, resp, "body", JS_NewArrayBufferCopy(ctx, NULL, 0));
+            JS_SetPropertyStr(ctx, resp, "stream", new_stream_handle(ctx, req->stream_id));
         } else {
-            JS_SetPropertyStr(ctx, resp, "body", JS_NewString(ctx, ""));
+            JS_SetPropertyStr(ctx, resp, "body", take_body_buffer(ctx, req));
         }
         arg = resp;
         fn = req->resolve;
     }
-
-    JSValue result = JS_Call(ctx, fn, JS_UNDEFINED, 1, &arg);
-    if (JS_IsException(result)) {
-        JSValue exc = JS_GetException(ctx);
-        const char *str = JS_ToCString(ctx, exc);
-        TraceLog(LOG_ERROR, "[fetch] error settling promise: %s", str ? str : "unknown");
-        JS_FreeCString(ctx, str);
-        JS_FreeValue(ctx, exc);
-    }
-    JS_FreeValue(ctx, result);
-    JS_FreeValue(ctx, arg);
+    settle_promise(ctx, fn, arg);
 }
 
-static void free_fetch_request(JSContext *ctx, FetchRequest *req)
+static void free_fetch_request(JSRuntime *rt, FetchRequest *req)
 {
-    JS_FreeValue(ctx, req->resolve);
-    JS_FreeValue(ctx, req->reject);
+    JS_FreeValueRT(rt, req->resolve);
+    JS_FreeValueRT(rt, req->reject);
+    JS_FreeValueRT(rt, req->read_resolve);
+    JS_FreeValueRT(rt, req->read_reject);
+    arrfree(req->stream_data);
     if (req->headers) curl_slist_free_all(req->headers);
     arena_free(&req->response_headers);
     arena_free(&req->response_body);
@@ -221,6 +682,153 @@ static void free_fetch_request(JSContext *ctx, FetchRequest *req)
     free(req);
 }
 
+// The JS side is done with req's stream: forget its id and stop the transfer if it is still
+// running. The request is freed here once the worker is done with it, otherwise by run_fetch.
+static void fetch_stream_release(JSRuntime *rt, FetchRequest *req)
+{
+    hmdel(fetch_streams, req->stream_id);
+    req->released = true;
+
+    vd_mutex_lock(fetch_mutex);
+    bool done = req->worker_done;
+    bool can_free = done && !req->update_queued;
+    if (!done) req->cancel_requested = true;
+    vd_mutex_unlock(fetch_mutex);
+
+    if (can_free) {
+        free_fetch_request(rt, req);
+    } else if (!done) {
+        curl_multi_wakeup(fetch_multi);
+    }
+}
+
+// A Response dropped without reading or cancelling its body would otherwise hold its transfer,
+// paused at FETCH_STREAM_HIGH_WATER, and its FETCH_MAX_CONCURRENT slot for the rest of the runtime.
+// GC can finalize the handle while run_fetch is working on the request, so the finalizer never
+// frees it: it cancels the transfer or queues the finished request, and run_fetch frees it.
+static void fetch_stream_finalizer(JSRuntime *rt, JSValue handle)
+{
+    (void)rt;
+    FetchRequest *req = stream_from_handle(handle);
+    if (!req) return;
+    hmdel(fetch_streams, req->stream_id);
+    req->released = true;
+
+    vd_mutex_lock(fetch_mutex);
+    bool done = req->worker_done;
+    if (done) {
+        fetch_queue_update_locked(req);
+    } else {
+        req->cancel_requested = true;
+    }
+    vd_mutex_unlock(fetch_mutex);
+
+    if (done) {
+        fetch_signal_updates();
+    } else {
+        curl_multi_wakeup(fetch_multi);
+    }
+}
+
+static void fetch_stream_settle_read(JSContext *ctx, FetchRequest *req, bool ok, JSValue arg)
+{
+    JSValue resolve = req->read_resolve;
+    JSValue reject = req->read_reject;
+    req->read_resolve = JS_UNDEFINED;
+    req->read_reject = JS_UNDEFINED;
+    settle_promise(ctx, ok ? resolve : reject, arg);
+    JS_FreeValue(ctx, resolve);
+    JS_FreeValue(ctx, reject);
+}
+
+static void free_stream_chunk(JSRuntime *rt, void *opaque, void *ptr)
+{
+    (void)rt;
+    (void)opaque;
+    char *data = ptr;
+    arrfree(data);
+}
+
+// Settle a pending nativeFetchRead with the bytes buffered so far, or with the end of the body
+// (undefined) or its error once the transfer is over. Reading resumes a paused transfer.
+static void fetch_stream_deliver(JSContext *ctx, FetchRequest *req)
+{
+    if (JS_IsUndefined(req->read_resolve)) return;
+
+    vd_mutex_lock(fetch_mutex);
+    char *data = req->stream_data;
+    req->stream_data = NULL;
+    bool done = req->worker_done;
+    bool resume = data && req->stream_paused;
+    if (resume) req->resume_requested = true;
+    vd_mutex_unlock(fetch_mutex);
+    if (resume) curl_multi_wakeup(fetch_multi);
+
+    size_t len = (size_t)arrlen(data);
+    if (len > 0) {
+        // The chunk buffer adopts the bytes; JS decodes them only if it asks for text.
+        JSValue chunk = JS_NewArrayBuffer(ctx, (uint8_t *)data, len, free_stream_chunk, NULL, false);
+        if (JS_IsException(chunk)) {
+            arrfree(data);
+            fetch_stream_settle_read(ctx, req, false, JS_GetException(ctx));
+        } else {
+            fetch_stream_settle_read(ctx, req, true, chunk);
+        }
+        return;
+    }
+    if (done) {
+        if (req->failed) {
+            fetch_stream_settle_read(ctx, req, false, fetch_error(ctx, req));
+        } else {
+            fetch_stream_settle_read(ctx, req, true, JS_UNDEFINED);
+        }
+        fetch_stream_release(JS_GetRuntime(ctx), req);
+    }
+    arrfree(data);
+}
+
+// A streaming request has new body data or finished: hand the response to JS the first time,
+// then feed any pending read.
+static void fetch_stream_update(JSContext *ctx, FetchRequest *req)
+{
+    vd_mutex_lock(fetch_mutex);
+    bool done = req->worker_done;
+    bool ready = req->headers_ready;
+    vd_mutex_unlock(fetch_mutex);
+
+    if (req->released) {
+        if (done) free_fetch_request(JS_GetRuntime(ctx), req);
+        return;
+    }
+    if (!req->response_sent) {
+        if (!ready && !done) return;
+        if (done && req->failed && !ready) {
+            resolve_fetch(ctx, req, true);
+            free_fetch_request(JS_GetRuntime(ctx), req);
+            return;
+        }
+        req->stream_id = ++fetch_next_stream_id;
+        hmput(fetch_streams, req->stream_id, req);
+        req->response_sent = true;
+        resolve_fetch(ctx, req, false);
+    }
+    fetch_stream_deliver(ctx, req);
+}
+
+// Requests that carry their own cache or range headers go straight to the network. So do requests with
+// credentials: the cache is keyed by URL and shared by every Deck App, so their responses must not be stored.
+static bool request_bypasses_cache(const struct curl_slist *headers)
+{
+    static const char *const names[] = {"cache-control:", "pragma:", "if-none-match:", "if-modified-since:",
+                                        "range:", "authorization:", "cookie:"};
+    for (const struct curl_slist *h = headers; h; h = h->next) {
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (strncasecmp(h->data, names[i], strlen(names[i])) == 0) return true;
+        }
+    }
+    return false;
+}
+
 static JSValue js_native_fetch(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
 {
     (void)this_val;
@@ -238,6 +846,9 @@ static JSValue js_native_fetch(JSContext *ctx, JSValueConst this_val, int argc,
     }
     req->resolve = promise_funcs[0];
     req->reject = promise_funcs[1];
+    req->read_resolve = JS_UNDEFINED;
+    req->read_reject = JS_UNDEFINED;
+    req->streaming = argc >= 5 && JS_ToBool(ctx, argv[4]) > 0;
 
     const char *url = JS_ToCString(ctx, argv[0]);
     const char *method = JS_ToCString(ctx, argv[1]);
@@ -276,59 +887,117 @@ static JSValue js_native_fetch(JSContext *ctx, JSValueConst this_val, int argc,
         }
     }
 
-    req->thread = vd_thread_create(fetch_worker, req);
-    if (!req->thread) {
+    req->cacheable = !req->streaming && strcmp(req->method, "GET") == 0 && !req->body &&
+                     !request_bypasses_cache(req->headers);
+
+    if (!fetch_thread && !fetch_engine_start()) {
         JSValue err = JS_NewError(ctx);
-        JS_SetPropertyStr(ctx, err, "message", JS_NewString(ctx, "Failed to start fetch thread"));
+        JS_SetPropertyStr(ctx, err, "message", JS_NewString(ctx, "Failed to start fetch worker"));
         JSValue r = JS_Call(ctx, req->reject, JS_UNDEFINED, 1, &err);
         JS_FreeValue(ctx, r);
         JS_FreeValue(ctx, err);
-        free_fetch_request(ctx, req);
+        free_fetch_request(JS_GetRuntime(ctx), req);
         return promise;
     }
 
     vd_mutex_lock(fetch_mutex);
-    arrput(fetch_pending, req);
+    arrput(fetch_submitted, req);
     vd_mutex_unlock(fetch_mutex);
+    curl_multi_wakeup(fetch_multi);
 
     return promise;
 }
 
+// nativeFetchRead(stream): resolves with an ArrayBuffer of the next body bytes, or undefined at the end.
+static JSValue js_native_fetch_read(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    (void)this_val;
+    if (argc < 1) return JS_ThrowTypeError(ctx, "nativeFetchRead requires a stream");
+    FetchRequest *req = stream_from_handle(argv[0]);
+    if (!req) return JS_ThrowTypeError(ctx, "nativeFetchRead: unknown stream");
+    if (!JS_IsUndefined(req->read_resolve)) return JS_ThrowTypeError(ctx, "nativeFetchRead: a read is already pending");
+
+    JSValue promise_funcs[2];
+    JSValue promise = JS_NewPromiseCapability(ctx, promise_funcs);
+    if (JS_IsException(promise)) return promise;
+    req->read_resolve = promise_funcs[0];
+    req->read_reject = promise_funcs[1];
+    fetch_stream_deliver(ctx, req);
+    return promise;
+}
+
+// nativeFetchCancel(stream): stop the transfer and end a pending read.
+static JSValue js_native_fetch_cancel(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    (void)this_val;
+    FetchRequest *req = argc >= 1 ? stream_from_handle(argv[0]) : NULL;
+    if (!req) return JS_UNDEFINED;
+    if (!JS_IsUndefined(req->read_resolve)) fetch_stream_settle_read(ctx, req, true, JS_UNDEFINED);
+    fetch_stream_release(JS_GetRuntime(ctx), req);
+    return JS_UNDEFINED;
+}
+
+// nativeDecodeText(buffer): the buffer's bytes decoded as UTF-8.
+static JSValue js_native_decode_text(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    (void)this_val;
+    if (argc < 1) return JS_ThrowTypeError(ctx, "nativeDecodeText requires an ArrayBuffer");
+    size_t size = 0;
+    uint8_t *data = JS_GetArrayBuffer(ctx, &size, argv[0]);
+    if (!data) return JS_EXCEPTION;
+    return JS_NewStringLen(ctx, (const char *)data, size);
+}
+
 void run_fetch(JSContext *ctx)
 {
-    if (!fetch_pending) return;
+    if (!atomic_load(&fetch_has_updates)) return;
 
-    FetchRequest **finished = NULL;
     vd_mutex_lock(fetch_mutex);
-    for (int i = (int)arrlen(fetch_pending) - 1; i >= 0; i--) {
-        if (fetch_pending[i]->done) {
-            arrput(finished, fetch_pending[i]);
-            arrdel(fetch_pending, i);
-        }
-    }
+    FetchRequest **updated = fetch_updates;
+    fetch_updates = NULL;
+    atomic_store(&fetch_has_updates, false);
     vd_mutex_unlock(fetch_mutex);
 
-    for (size_t i = 0; i < arrlen(finished); i++) {
-        FetchRequest *req = finished[i];
-        vd_thread_join(req->thread);
-        vd_thread_destroy(req->thread);
-        resolve_fetch(ctx, req);
-        free_fetch_request(ctx, req);
+    for (size_t i = 0; i < arrlen(updated); i++) {
+        FetchRequest *req = updated[i];
+        // Cleared one request at a time: a request later in the batch stays queued, so nothing
+        // (e.g. fetch_stream_release from a read settled here) frees it before it is handled.
+        vd_mutex_lock(fetch_mutex);
+        req->update_queued = false;
+        vd_mutex_unlock(fetch_mutex);
+        if (req->streaming) {
+            fetch_stream_update(ctx, req);
+        } else {
+            resolve_fetch(ctx, req, req->failed);
+            free_fetch_request(JS_GetRuntime(ctx), req);
+        }
     }
-    arrfree(finished);
+    arrfree(updated);
 }
 
+// Requests still queued, in flight or being streamed are dropped without settling their promises:
+// the context is about to be freed.
 void fetch_shutdown(JSContext *ctx)
 {
-    if (!fetch_pending) return;
-    for (size_t i = 0; i < arrlen(fetch_pending); i++) {
-        FetchRequest *req = fetch_pending[i];
-        vd_thread_join(req->thread);
-        vd_thread_destroy(req->thread);
-        free_fetch_request(ctx, req);
+    JSRuntime *rt = JS_GetRuntime(ctx);
+    fetch_engine_stop();
+    // Stopping the worker queued every unfinished request, so only free streams that are not queued.
+    for (size_t i = 0; i < hmlen(fetch_streams); i++) {
+        if (!fetch_streams[i].value->update_queued) free_fetch_request(rt, fetch_streams[i].value);
     }
-    arrfree(fetch_pending);
-    fetch_pending = NULL;
+    for (size_t i = 0; i < arrlen(fetch_submitted); i++) {
+        free_fetch_request(rt, fetch_submitted[i]);
+    }
+    for (size_t i = 0; i < arrlen(fetch_updates); i++) {
+        free_fetch_request(rt, fetch_updates[i]);
+    }
+    hmfree(fetch_streams);
+    arrfree(fetch_submitted);
+    arrfree(fetch_updates);
+    fetch_streams = NULL;
+    fetch_submitted = NULL;
+    fetch_updates = NULL;
+    atomic_store(&fetch_has_updates, false);
 }
 
 void register_js_fetch(JSContext *ctx)
@@ -339,6 +1008,15 @@ void register_js_fetch(JSContext *ctx)
         curl_initialized = true;
     }
     if (!fetch_mutex) fetch_mutex = vd_mutex_create();
+    atomic_init(&fetch_has_updates, false);
+
+    JSRuntime *rt = JS_GetRuntime(ctx);
+    JS_NewClassID(rt, &fetch_stream_class_id);
+    JSClassDef stream_class = {.class_name = "FetchStream", .finalizer = fetch_stream_finalizer};
+    JS_NewClass(rt, fetch_stream_class_id, &stream_class);
 
-    js_set_global_function(ctx, "nativeFetch", js_native_fetch, 4);
+    js_set_global_function(ctx, "nativeFetch", js_native_fetch, 5);
+    js_set_global_function(ctx, "nativeFetchRead", js_native_fetch_read, 1);
+    js_set_global_function(ctx, "nativeFetchCancel", js_native_fetch_cancel, 1);
+    js_set_global_function(ctx, "nativeDecodeText", js_native_decode_text, 1);
 }
@@ -0,0 +1,542 @@
+#include "http_cache.h"
+
+#include <curl/curl.h>
+#include <dirent.h>
+#include <errno.h>
+#include <raylib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include "stb_ds.h"
+#include "core/package_library.h"
+
+// Metadata file layout: a "key value" line per field, a blank line, then the raw response headers.
+#define HTTP_CACHE_MAGIC "VDCACHE 1"
+// Responses larger than this fraction of the budget are not stored.
+#define HTTP_CACHE_ENTRY_DIVISOR 4
+
+typedef struct {
+    uint64_t hash;
+    time_t stored;
+    long lifetime; // seconds the entry stays fresh after stored
+    size_t size;
+    time_t last_used;
+    char etag[HTTP_CACHE_ETAG_MAX];
+    char last_modified[HTTP_CACHE_DATE_MAX];
+} HttpCacheEntry;
+
+typedef struct {
+    char *key; // URL
+    HttpCacheEntry value;
+} HttpCacheSlot;
+
+// A parsed metadata file; the pointers point into the file contents.
+typedef struct {
+    const char *url;
+    long status;
+    const char *status_line;
+    const char *headers;
+    size_t headers_size;
+    HttpCacheEntry entry;
+} HttpCacheMeta;
+
+static HttpCacheSlot *cache_index = NULL;
+static char cache_dir[VD_PATH_MAX];
+static size_t cache_max_bytes = 0;
+static size_t cache_bytes = 0;
+static bool cache_opened = false;
+
+static uint64_t url_hash(const char *url)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char *p = (const unsigned char *)url; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void entry_path(char *out, size_t out_size, uint64_t hash, const char *extension)
+{
+    snprintf(out, out_size, "%s/%016llx.%s", cache_dir, (unsigned long long)hash, extension);
+}
+
+static bool has_suffix(const char *value, const char *suffix)
+{
+    size_t value_len = strlen(value);
+    size_t suffix_len = strlen(suffix);
+    return value_len >= suffix_len && strcmp(value + value_len - suffix_len, suffix) == 0;
+}
+
+static char *read_file(const char *path, size_t *out_size)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    if (fseek(f, 0, SEEK_END) != 0) {
+        fclose(f);
+        return NULL;
+    }
+    long len = ftell(f);
+    if (len < 0) {
+        fclose(f);
+        return NULL;
+    }
+    rewind(f);
+    char *buffer = malloc((size_t)len + 1);
+    if (!buffer) {
+        fclose(f);
+        return NULL;
+    }
+    size_t read_len = fread(buffer, 1, (size_t)len, f);
+    buffer[read_len] = '\0';
+    fclose(f);
+    if (out_size) *out_size = read_len;
+    return buffer;
+}
+
+// Write through a temporary file so a crash never leaves a truncated entry behind.
+static bool write_file(const char *path, const char *prefix, const char *data, size_t size)
+{
+    char tmp[VD_PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return false;
+    bool ok = !prefix || fputs(prefix, f) >= 0;
+    if (ok && size > 0) ok = fwrite(data, 1, size, f) == size;
+    if (fclose(f) != 0) ok = false;
+    remove(path);
+    if (ok && rename(tmp, path) != 0) ok = false;
+    if (!ok) remove(tmp);
+    return ok;
+}
+
+static void copy_value(char *out, size_t out_size, const char *value, size_t len)
+{
+    if (len >= out_size) len = out_size - 1;
+    memcpy(out, value, len);
+    out[len] = '\0';
+}
+
+// Copy the value of header name (case-insensitive) from raw header lines. False when absent.
+static bool header_value(const char *headers, size_t size, const char *name, char *out, size_t out_size)
+{
+    size_t name_len = strlen(name);
+    const char *p = headers;
+    const char *end = headers ? headers + size : NULL;
+    while (p && p < end) {
+        const char *line_end = memchr(p, '\n', (size_t)(end - p));
+        if (!line_end) line_end = end;
+        if ((size_t)(line_end - p) > name_len && strncasecmp(p, name, name_len) == 0 && p[name_len] == ':') {
+            const char *value = p + name_len + 1;
+            while (value < line_end && (*value == ' ' || *value == '\t'))
+                value++;
+            const char *value_end = line_end;
+            while (value_end > value && (value_end[-1] == '\r' || value_end[-1] == ' ' || value_end[-1] == '\t'))
+                value_end--;
+            copy_value(out, out_size, value, (size_t)(value_end - value));
+            return true;
+        }
+        p = line_end + 1;
+    }
+    return false;
+}
+
+// Seconds a response stays fresh after it is received, or -1 if it must not be stored.
+static long freshness_lifetime(const char *headers, size_t size, time_t now)
+{
+    char value[256];
+    // Entries are keyed by URL alone, so a response selected by request headers cannot be replayed safely.
+    if (header_value(headers, size, "vary", value, sizeof(value)) && value[0]) return -1;
+
+    long age = 0;
+    if (header_value(headers, size, "age", value, sizeof(value))) age = strtol(value, NULL, 10);
+
+    if (header_value(headers, size, "cache-control", value, sizeof(value))) {
+        bool no_cache = false;
+        long max_age = -1;
+        for (const char *token = value; *token;) {
+            while (*token == ' ' || *token == ',')
+                token++;
+            if (strncasecmp(token, "no-store", 8) == 0) return -1;
+            if (strncasecmp(token, "private", 7) == 0) return -1;
+            if (strncasecmp(token, "no-cache", 8) == 0) no_cache = true;
+            if (strncasecmp(token, "max-age=", 8) == 0) max_age = strtol(token + 8, NULL, 10);
+            while (*token && *token != ',')
+                token++;
+        }
+        if (no_cache) return 0;
+        if (max_age >= 0) return max_age > age ? max_age - age : 0;
+    }
+
+    if (header_value(headers, size, "expires", value, sizeof(value))) {
+        time_t expires = curl_getdate(value, NULL);
+        time_t date = now;
+        if (header_value(headers, size, "date", value, sizeof(value))) {
+            time_t parsed = curl_getdate(value, NULL);
+            if (parsed > 0) date = parsed;
+        }
+        long lifetime = expires > date ? (long)(expires - date) - age : 0;
+        return lifetime > 0 ? lifetime : 0;
+    }
+    return 0;
+}
+
+// True when name (name_len bytes) appears as a token of the comma-separated list.
+static bool list_has_token(const char *list, const char *name, size_t name_len)
+{
+    for (const char *token = list; *token;) {
+        while (*token == ' ' || *token == '\t' || *token == ',')
+            token++;
+        size_t len = strcspn(token, ", \t");
+        if (len == name_len && strncasecmp(token, name, len) == 0) return true;
+        token += len;
+    }
+    return false;
+}
+
+// The header lines that may be replayed to other requests: the cache is shared by every Deck App,
+// so Set-Cookie stays out, and so do the hop-by-hop headers of the connection that carried the
+// response, including those its Connection header names. Returns a malloc'd copy.
+static char *storable_headers(const char *headers, size_t size, size_t *out_size)
+{
+    static const char *const dropped[] = {"connection", "keep-alive", "proxy-authenticate", "proxy-authorization",
+                                          "proxy-connection", "te", "trailer", "transfer-encoding", "upgrade",
+                                          "set-cookie", "set-cookie2"};
+    char connection[256] = "";
+    header_value(headers, size, "connection", connection, sizeof(connection));
+
+    char *out = malloc(size + 1);
+    if (!out) return NULL;
+    size_t out_len = 0;
+    const char *p = headers;
+    const char *end = headers ? headers + size : NULL;
+    while (p && p < end) {
+        const char *line_end = memchr(p, '\n', (size_t)(end - p));
+        line_end = line_end ? line_end + 1 : end;
+        const char *colon = memchr(p, ':', (size_t)(line_end - p));
+        bool keep = true;
+        if (colon) {
+            size_t name_len = (size_t)(colon - p);
+            for (size_t i = 0; keep && i < sizeof(dropped) / sizeof(dropped[0]); i++) {
+                if (strlen(dropped[i]) == name_len && strncasecmp(p, dropped[i], name_len) == 0) keep = false;
+            }
+            if (keep && list_has_token(connection, p, name_len)) keep = false;
+        }
+        if (keep) {
+            memcpy(out + out_len, p, (size_t)(line_end - p));
+            out_len += (size_t)(line_end - p);
+        }
+        p = line_end;
+    }
+    out[out_len] = '\0';
+    *out_size = out_len;
+    return out;
+}
+
+static bool write_meta(const char *url, const HttpCacheEntry *entry, const char *status_line, const char *headers,
+                       size_t headers_size)
+{
+    char path[VD_PATH_MAX];
+    entry_path(path, sizeof(path), entry->hash, "meta");
+
+    size_t prefix_size = strlen(url) + strlen(status_line) + sizeof(entry->etag) + sizeof(entry->last_modified) + 256;
+    char *prefix = malloc(prefix_size);
+    if (!prefix) return false;
+    snprintf(prefix, prefix_size,
+             HTTP_CACHE_MAGIC "\nurl %s\nstored %lld\nlifetime %ld\nsize %zu\nstatus 200\netag %s\n"
+                              "last-modified %s\nstatus-line %s\n\n",
+             url, (long long)entry->stored, entry->lifetime, entry->size, entry->etag, entry->last_modified,
+             status_line);
+    bool ok = write_file(path, prefix, headers, headers_size);
+    free(prefix);
+    return ok;
+}
+
+// Parse a metadata file in place: the fields are NUL-terminated inside text.
+static bool parse_meta(char *text, size_t size, HttpCacheMeta *meta)
+{
+    memset(meta, 0, sizeof(*meta));
+    char *end = text + size;
+    char *line = text;
+    bool magic = false;
+    while (line < end) {
+        char *line_end = memchr(line, '\n', (size_t)(end - line));
+        if (!line_end) return false;
+        *line_end = '\0';
+        if (line == line_end) {
+            meta->headers = line_end + 1;
+            meta->headers_size = (size_t)(end - meta->headers);
+            return magic && meta->url && meta->status_line;
+        }
+        if (strcmp(line, HTTP_CACHE_MAGIC) == 0) {
+            magic = true;
+        } else if (strncmp(line, "url ", 4) == 0) {
+            meta->url = line + 4;
+        } else if (strncmp(line, "stored ", 7) == 0) {
+            meta->entry.stored = (time_t)strtoll(line + 7, NULL, 10);
+        } else if (strncmp(line, "lifetime ", 9) == 0) {
+            meta->entry.lifetime = strtol(line + 9, NULL, 10);
+        } else if (strncmp(line, "size ", 5) == 0) {
+            meta->entry.size = (size_t)strtoull(line + 5, NULL, 10);
+        } else if (strncmp(line, "status ", 7) == 0) {
+            meta->status = strtol(line + 7, NULL, 10);
+        } else if (strncmp(line, "etag ", 5) == 0) {
+            copy_value(meta->entry.etag, sizeof(meta->entry.etag), line + 5, strlen(line + 5));
+        } else if (strncmp(line, "last-modified ", 14) == 0) {
+            copy_value(meta->entry.last_modified, sizeof(meta->entry.last_modified), line + 14, strlen(line + 14));
+        } else if (strncmp(line, "status-line ", 12) == 0) {
+            meta->status_line = line + 12;
+        }
+        line = line_end + 1;
+    }
+    return false;
+}
+
+static void delete_entry_files(uint64_t hash)
+{
+    char path[VD_PATH_MAX];
+    entry_path(path, sizeof(path), hash, "body");
+    remove(path);
+    entry_path(path, sizeof(path), hash, "meta");
+    remove(path);
+}
+
+void http_cache_remove(const char *url)
+{
+    ptrdiff_t index = shgeti(cache_index, url);
+    if (index < 0) return;
+    delete_entry_files(cache_index[index].value.hash);
+    cache_bytes -= cache_index[index].value.size;
+    shdel(cache_index, url);
+}
+
+// Drop least recently used entries until incoming more bytes fit in the budget.
+static void evict_for(size_t incoming)
+{
+    while (shlen(cache_index) > 0 && cache_bytes + incoming > cache_max_bytes) {
+        ptrdiff_t oldest = 0;
+        for (ptrdiff_t i = 1; i < shlen(cache_index); i++) {
+            if (cache_index[i].value.last_used < cache_index[oldest].value.last_used) oldest = i;
+        }
+        http_cache_remove(cache_index[oldest].key);
+    }
+}
+
+// Index one metadata file; an unreadable entry or one whose body is missing is deleted.
+static void load_entry(const char *name)
+{
+    char path[VD_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", cache_dir, name);
+    uint64_t hash = strtoull(name, NULL, 16);
+
+    size_t size = 0;
+    char *text = read_file(path, &size);
+    HttpCacheMeta meta;
+    bool ok = text && parse_meta(text, size, &meta) && url_hash(meta.url) == hash;
+    if (ok) {
+        char body_path[VD_PATH_MAX];
+        entry_path(body_path, sizeof(body_path), hash, "body");
+        struct stat st;
+        ok = stat(body_path, &st) == 0 && (size_t)st.st_size == meta.entry.size;
+    }
+    if (ok) {
+        meta.entry.hash = hash;
+        meta.entry.last_used = meta.entry.stored;
+        shput(cache_index, meta.url, meta.entry);
+        cache_bytes += meta.entry.size;
+    } else {
+        delete_entry_files(hash);
+    }
+    free(text);
+}
+
+bool http_cache_open(const char *dir, size_t max_bytes)
+{
+    http_cache_close();
+    snprintf(cache_dir, sizeof(cache_dir), "%s", dir);
+    cache_max_bytes = max_bytes;
+    if (mkdir(cache_dir, 0777) != 0 && errno != EEXIST) {
+        TraceLog(LOG_WARNING, "HTTP cache: could not create %s.", cache_dir);
+        return false;
+    }
+    DIR *d = opendir(cache_dir);
+    if (!d) {
+        TraceLog(LOG_WARNING, "HTTP cache: could not open %s.", cache_dir);
+        return false;
+    }
+
+    sh_new_strdup(cache_index);
+    char **stale = NULL;
+    struct dirent *entry;
+    while ((entry = readdir(d))) {
+        if (entry->d_name[0] == '.') continue;
+        if (has_suffix(entry->d_name, ".meta")) {
+            load_entry(entry->d_name);
+        } else if (has_suffix(entry->d_name, ".tmp")) {
+            arrput(stale, strdup(entry->d_name));
+        }
+    }
+    closedir(d);
+
+    // Leftovers of writes that were interrupted. Bodies without metadata are overwritten on the
+    // next store of their URL, or stay unindexed and are not counted against the budget.
+    for (size_t i = 0; i < arrlen(stale); i++) {
+        char path[VD_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", cache_dir, stale[i]);
+        remove(path);
+        free(stale[i]);
+    }
+    arrfree(stale);
+
+    cache_opened = true;
+    evict_for(0);
+    return true;
+}
+
+void http_cache_close(void)
+{
+    shfree(cache_index);
+    cache_index = NULL;
+    cache_bytes = 0;
+    cache_opened = false;
+}
+
+HttpCacheLookup http_cache_lookup(const char *url, time_t now, HttpCacheValidators *validators)
+{
+    if (!cache_opened) return HTTP_CACHE_MISS;
+    ptrdiff_t index = shgeti(cache_index, url);
+    if (index < 0) return HTTP_CACHE_MISS;
+
+    HttpCacheEntry *entry = &cache_index[index].value;
+    entry->last_used = now;
+    if (now >= entry->stored && now - entry->stored < entry->lifetime) return HTTP_CACHE_FRESH;
+    if (!entry->etag[0] && !entry->last_modified[0]) return HTTP_CACHE_MISS;
+    if (validators) {
+        snprintf(validators->etag, sizeof(validators->etag), "%s", entry->etag);
+        snprintf(validators->last_modified, sizeof(validators->last_modified), "%s", entry->last_modified);
+    }
+    return HTTP_CACHE_STALE;
+}
+
+bool http_cache_load(const char *url, HttpCacheResponse *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!cache_opened) return false;
+    ptrdiff_t index = shgeti(cache_index, url);
+    if (index < 0) return false;
+    HttpCacheEntry *entry = &cache_index[index].value;
+
+    char path[VD_PATH_MAX];
+    entry_path(path, sizeof(path), entry->hash, "meta");
+    size_t meta_size = 0;
+    char *text = read_file(path, &meta_size);
+    HttpCacheMeta meta;
+    entry_path(path, sizeof(path), entry->hash, "body");
+    out->body = text && parse_meta(text, meta_size, &meta) ? read_file(path, &out->body_size) : NULL;
+
+    bool ok = out->body && out->body_size == entry->size;
+    if (ok) {
+        out->status = meta.status;
+        out->status_line = strdup(meta.status_line);
+        out->headers = malloc(meta.headers_size + 1);
+        ok = out->status_line && out->headers;
+    }
+    if (ok) {
+        memcpy(out->headers, meta.headers, meta.headers_size);
+        out->headers[meta.headers_size] = '\0';
+        out->headers_size = meta.headers_size;
+    }
+    free(text);
+    if (!ok) {
+        http_cache_response_free(out);
+        http_cache_remove(url);
+    }
+    return ok;
+}
+
+void http_cache_response_free(HttpCacheResponse *response)
+{
+    free(response->status_line);
+    free(response->headers);
+    free(response->body);
+    memset(response, 0, sizeof(*response));
+}
+
+bool http_cache_store(const char *url, time_t now, const char *status_line, const char *headers,
+                      size_t headers_size, const char *body, size_t body_size)
+{
+    if (!cache_opened) return false;
+    http_cache_remove(url);
+
+    HttpCacheEntry entry = {.hash = url_hash(url), .stored = now, .size = body_size, .last_used = now};
+    entry.lifetime = freshness_lifetime(headers, headers_size, now);
+    header_value(headers, headers_size, "etag", entry.etag, sizeof(entry.etag));
+    header_value(headers, headers_size, "last-modified", entry.last_modified, sizeof(entry.last_modified));
+    if (entry.lifetime < 0 || (entry.lifetime == 0 && !entry.etag[0] && !entry.last_modified[0])) return false;
+    if (body_size > cache_max_bytes / HTTP_CACHE_ENTRY_DIVISOR) return false;
+
+    if (!status_line) status_line = "HTTP/1.1 200 OK";
+
+    size_t stored_size = 0;
+    char *stored = storable_headers(headers, headers_size, &stored_size);
+    if (!stored) return false;
+
+    evict_for(body_size);
+    char path[VD_PATH_MAX];
+    entry_path(path, sizeof(path), entry.hash, "body");
+    bool ok = write_file(path, NULL, body, body_size) && write_meta(url, &entry, status_line, stored, stored_size);
+    free(stored);
+    if (!ok) {
+        TraceLog(LOG_WARNING, "HTTP cache: could not store %s.", url);
+        delete_entry_files(entry.hash);
+        return false;
+    }
+    shput(cache_index, url, entry);
+    cache_bytes += body_size;
+    return true;
+}
+
+void http_cache_refresh(const char *url, time_t now, const char *headers, size_t headers_size)
+{
+    if (!cache_opened) return;
+    ptrdiff_t index = shgeti(cache_index, url);
+    if (index < 0) return;
+    HttpCacheEntry entry = cache_index[index].value;
+
+    char value[64];
+    if (header_value(headers, headers_size, "cache-control", value, sizeof(value)) ||
+        header_value(headers, headers_size, "expires", value, sizeof(value))) {
+        entry.lifetime = freshness_lifetime(headers, headers_size, now);
+        if (entry.lifetime < 0) {
+            http_cache_remove(url);
+            return;
+        }
+    }
+    header_value(headers, headers_size, "etag", entry.etag, sizeof(entry.etag));
+    header_value(headers, headers_size, "last-modified", entry.last_modified, sizeof(entry.last_modified));
+    entry.stored = now;
+    entry.last_used = now;
+
+    // Rewrite the metadata with the stored status line and headers.
+    char path[VD_PATH_MAX];
+    entry_path(path, sizeof(path), entry.hash, "meta");
+    size_t meta_size = 0;
+    char *text = read_file(path, &meta_size);
+    HttpCacheMeta meta;
+    if (!text || !parse_meta(text, meta_size, &meta) ||
+        !write_meta(url, &entry, meta.status_line, meta.headers, meta.headers_size)) {
+        free(text);
+        http_cache_remove(url);
+        return;
+    }
+    free(text);
+    cache_index[index].value = entry;
+}
+
+size_t http_cache_size(void)
+{
+    return cache_bytes;
+}
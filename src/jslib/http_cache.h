@@ -0,0 +1,58 @@
+#ifndef HTTP_CACHE_H
+#define HTTP_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+// On-disk cache of GET responses for fetch. Each URL has a body file and a small metadata file
+// under the cache directory; the metadata of every entry is kept in an in-memory index, and the
+// least recently used entries are evicted once the bodies exceed the size budget. Freshness follows
+// Cache-Control (no-store, no-cache, max-age), Expires, Date and Age; stale entries with an ETag or
+// Last-Modified are revalidated with a conditional request. The cache is shared and keyed by URL
+// alone, so private responses and responses with a Vary header are never stored.
+//
+// Not thread-safe: the fetch network worker is its only user.
+
+#define HTTP_CACHE_ETAG_MAX 256
+#define HTTP_CACHE_DATE_MAX 64
+
+typedef enum { HTTP_CACHE_MISS, HTTP_CACHE_FRESH, HTTP_CACHE_STALE } HttpCacheLookup;
+
+// Validators of a stale entry, for If-None-Match / If-Modified-Since. Empty when absent.
+typedef struct {
+    char etag[HTTP_CACHE_ETAG_MAX];
+    char last_modified[HTTP_CACHE_DATE_MAX];
+} HttpCacheValidators;
+
+// A stored response. Every pointer is malloc'd; release with http_cache_response_free.
+typedef struct {
+    long status;
+    char *status_line; // e.g. "HTTP/1.1 200 OK"
+    char *headers;     // raw "Name: value\r\n" lines
+    size_t headers_size;
+    char *body;
+    size_t body_size;
+} HttpCacheResponse;
+
+// Load the index of the entries under dir (created if missing). Entries that cannot be read are
+// deleted. While the cache is closed every lookup misses and nothing is stored.
+bool http_cache_open(const char *dir, size_t max_bytes);
+void http_cache_close(void);
+
+HttpCacheLookup http_cache_lookup(const char *url, time_t now, HttpCacheValidators *validators);
+bool http_cache_load(const char *url, HttpCacheResponse *out);
+void http_cache_response_free(HttpCacheResponse *response);
+
+// Store a 200 response under url when its headers allow it, replacing any earlier entry. Set-Cookie
+// and hop-by-hop headers are left out of the stored headers. Returns true if it was stored.
+bool http_cache_store(const char *url, time_t now, const char *status_line, const char *headers,
+                      size_t headers_size, const char *body, size_t body_size);
+// A 304 answered the revalidation of url: restart its freshness from the 304's headers.
+void http_cache_refresh(const char *url, time_t now, const char *headers, size_t headers_size);
+void http_cache_remove(const char *url);
+
+// Total size of the stored bodies, in bytes.
+size_t http_cache_size(void);
+
+#endif /* HTTP_CACHE_H */
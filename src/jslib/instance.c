@@ -1,682 +1,441 @@
 // JS bindings for instance tree operations
 
+#include <stddef.h>
+
 #include "jslib_internal.h"
+#include "jslib.h"
 #include "ui/images.h"
 #include "ui/instance_tree.h"
 
-static JSValue native_create_rect(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+// Mutation command stream written by js/packages/runtime/src/mutation-buffer.ts.
+// Every field is a little-endian 32-bit word; instances are InstanceHandles (0 for the
+// root container) and strings are indices into the string table passed alongside the
+// buffer (MUT_STRING_NONE for "no string"). Keep opcodes and layouts in sync with the JS encoder.
+typedef enum {
+    MUT_CREATE = 1,          // handle, node type, props
+    MUT_UPDATE = 2,          // handle, node type, field mask, changed props
+    MUT_APPEND_CHILD = 3,    // parent handle, child handle
+    MUT_INSERT_BEFORE = 4,   // parent handle, child handle, before handle
+    MUT_REMOVE_CHILD = 5,    // parent handle, child handle
+    MUT_DESTROY = 6,         // handle
+    MUT_CLEAR_CONTAINER = 7, // (no operands)
+} MutationOp;
+
+#define MUT_STRING_NONE 0xFFFFFFFFu
+
+static MutationStats mutation_stats;
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    const char **strings;
+    uint32_t string_count;
+    bool error;
+} MutationReader;
+
+static uint32_t read_u32(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 16) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-
-    ReactInstance *inst = calloc(1, sizeof(ReactInstance));
-    inst->id = strdup(id);
-    inst->type = NT_RECT;
-
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[1]);
-    inst->props.rect.x = tmp;
-    JS_ToInt32(ctx, &tmp, argv[2]);
-    inst->props.rect.y = tmp;
-    JS_ToInt32(ctx, &tmp, argv[3]);
-    inst->props.rect.width = tmp;
-    JS_ToInt32(ctx, &tmp, argv[4]);
-    inst->props.rect.height = tmp;
-    inst->props.rect.has_fill = JS_ToBool(ctx, argv[5]);
-    if (inst->props.rect.has_fill) {
-        int32_t r, g, b, a;
-        JS_ToInt32(ctx, &r, argv[6]);
-        JS_ToInt32(ctx, &g, argv[7]);
-        JS_ToInt32(ctx, &b, argv[8]);
-        JS_ToInt32(ctx, &a, argv[9]);
-        inst->props.rect.fill_color = (Color){r, g, b, a};
-    }
-    inst->props.rect.has_outline = JS_ToBool(ctx, argv[10]);
-    if (inst->props.rect.has_outline) {
-        int32_t r, g, b, a;
-        JS_ToInt32(ctx, &r, argv[11]);
-        JS_ToInt32(ctx, &g, argv[12]);
-        JS_ToInt32(ctx, &b, argv[13]);
-        JS_ToInt32(ctx, &a, argv[14]);
-        inst->props.rect.border_color = (Color){r, g, b, a};
+    if (r->error || r->pos + 4 > r->size) {
+        r->error = true;
+        return 0;
     }
-    double border_radius;
-    JS_ToFloat64(ctx, &border_radius, argv[15]);
-    inst->props.rect.border_radius = (float)border_radius;
-    inst->children = NULL;
-    inst->parent = NULL;
-
-    instance_back_put(inst);
-    JS_FreeCString(ctx, id);
-    return JS_UNDEFINED;
+    uint32_t value;
+    memcpy(&value, r->data + r->pos, sizeof(value));
+    r->pos += 4;
+    return value;
 }
 
-static void read_text_layout_props(JSContext *ctx, TextProps *text, JSValueConst *argv, int layout_start)
+static int read_i32(MutationReader *r)
 {
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[layout_start]);
-    text->x = tmp;
-    JS_ToInt32(ctx, &tmp, argv[layout_start + 1]);
-    text->y = tmp;
-    JS_ToInt32(ctx, &tmp, argv[layout_start + 2]);
-    text->width = tmp;
-    JS_ToInt32(ctx, &tmp, argv[layout_start + 3]);
-    text->line_height = tmp;
-    JS_ToInt32(ctx, &tmp, argv[layout_start + 4]);
-    text->align = (TextAlign)tmp;
-    JS_ToInt32(ctx, &tmp, argv[layout_start + 5]);
-    text->wrap = (TextWrap)tmp;
+    return (int32_t)read_u32(r);
 }
 
-static JSValue native_create_text(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static float read_f32(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 15) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-    const char *font_name = JS_ToCString(ctx, argv[1]);
-
-    ReactInstance *inst = calloc(1, sizeof(ReactInstance));
-    inst->id = strdup(id);
-    inst->type = NT_TEXT;
-    inst->props.text.font_name = strdup(font_name ? font_name : "default");
-
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[2]);
-    inst->props.text.font_size = tmp;
-    inst->props.text.has_color = JS_ToBool(ctx, argv[3]);
-    if (inst->props.text.has_color) {
-        int32_t r, g, b, a;
-        JS_ToInt32(ctx, &r, argv[4]);
-        JS_ToInt32(ctx, &g, argv[5]);
-        JS_ToInt32(ctx, &b, argv[6]);
-        JS_ToInt32(ctx, &a, argv[7]);
-        inst->props.text.color = (Color){r, g, b, a};
-    }
-    inst->props.text.border = JS_ToBool(ctx, argv[8]);
-    read_text_layout_props(ctx, &inst->props.text, argv, 9);
-    inst->children = NULL;
-    inst->parent = NULL;
-
-    instance_back_put(inst);
-    JS_FreeCString(ctx, id);
-    JS_FreeCString(ctx, font_name);
-    return JS_UNDEFINED;
+    uint32_t bits = read_u32(r);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
-static JSValue native_create_button(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+// Colors are packed as r | g << 8 | b << 16 | a << 24.
+static Color read_color(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 16) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-
-    ReactInstance *inst = calloc(1, sizeof(ReactInstance));
-    inst->id = strdup(id);
-    inst->type = NT_BUTTON;
-
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[1]);
-    inst->props.button.x = tmp;
-    JS_ToInt32(ctx, &tmp, argv[2]);
-    inst->props.button.y = tmp;
-    JS_ToInt32(ctx, &tmp, argv[3]);
-    inst->props.button.width = tmp;
-    JS_ToInt32(ctx, &tmp, argv[4]);
-    inst->props.button.height = tmp;
-
-    int32_t r, g, b, a;
-    JS_ToInt32(ctx, &r, argv[5]);
-    JS_ToInt32(ctx, &g, argv[6]);
-    JS_ToInt32(ctx, &b, argv[7]);
-    JS_ToInt32(ctx, &a, argv[8]);
-    inst->props.button.color = (Color){r, g, b, a};
-
-    const char *label = JS_ToCString(ctx, argv[9]);
-    inst->props.button.label = strdup(label ? label : "");
-    JS_FreeCString(ctx, label);
-
-    JS_ToInt32(ctx, &tmp, argv[10]);
-    inst->props.button.font_size = tmp;
-
-    double border_radius;
-    JS_ToFloat64(ctx, &border_radius, argv[11]);
-    inst->props.button.border_radius = (float)border_radius;
-
-    int32_t tr, tg, tb, ta;
-    JS_ToInt32(ctx, &tr, argv[12]);
-    JS_ToInt32(ctx, &tg, argv[13]);
-    JS_ToInt32(ctx, &tb, argv[14]);
-    JS_ToInt32(ctx, &ta, argv[15]);
-    inst->props.button.text_color = (Color){tr, tg, tb, ta};
-    inst->children = NULL;
-    inst->parent = NULL;
-
-    instance_back_put(inst);
-    JS_FreeCString(ctx, id);
-    return JS_UNDEFINED;
+    uint32_t packed = read_u32(r);
+    return (Color){packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF, (packed >> 24) & 0xFF};
 }
 
-static void read_scroll_props(JSContext *ctx, ScrollProps *scroll, JSValueConst *argv)
+// Borrowed from the string table; valid until the end of the apply call.
+static const char *read_string(MutationReader *r)
 {
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[1]);
-    scroll->x = tmp;
-    JS_ToInt32(ctx, &tmp, argv[2]);
-    scroll->y = tmp;
-    JS_ToInt32(ctx, &tmp, argv[3]);
-    scroll->width = tmp;
-    JS_ToInt32(ctx, &tmp, argv[4]);
-    scroll->height = tmp;
-    scroll->has_fill = JS_ToBool(ctx, argv[5]);
-    if (scroll->has_fill) {
-        int32_t r, g, b, a;
-        JS_ToInt32(ctx, &r, argv[6]);
-        JS_ToInt32(ctx, &g, argv[7]);
-        JS_ToInt32(ctx, &b, argv[8]);
-        JS_ToInt32(ctx, &a, argv[9]);
-        scroll->fill_color = (Color){r, g, b, a};
+    uint32_t index = read_u32(r);
+    if (index == MUT_STRING_NONE) return NULL;
+    if (index >= r->string_count) {
+        r->error = true;
+        return NULL;
     }
-    JS_ToInt32(ctx, &tmp, argv[10]);
-    scroll->gap = tmp;
-    JS_ToInt32(ctx, &tmp, argv[11]);
-    scroll->padding = tmp;
+    return r->strings[index];
 }
 
-static JSValue native_create_scroll(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static ReactInstance *read_instance(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 12) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-
-    ReactInstance *inst = calloc(1, sizeof(ReactInstance));
-    inst->id = strdup(id);
-    inst->type = NT_SCROLL;
-    read_scroll_props(ctx, &inst->props.scroll, argv);
-    inst->children = NULL;
-    inst->parent = NULL;
-
-    instance_back_put(inst);
-    JS_FreeCString(ctx, id);
-    return JS_UNDEFINED;
+    return instance_back_find(read_u32(r));
 }
 
-static JSValue native_update_scroll(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+// Prop layouts: the fields of each node type in stream order. Creates carry every field;
+// updates carry a bitmask (bit i = field i) followed by only the fields that changed.
+typedef enum { FIELD_I32, FIELD_BOOL, FIELD_F32, FIELD_COLOR, FIELD_STRING } PropFieldKind;
+
+typedef struct {
+    PropFieldKind kind;
+    size_t offset;
+} PropField;
+
+#define PROP_FIELD(kind, type, member) {kind, offsetof(type, member)}
+
+_Static_assert(sizeof(TextAlign) == sizeof(int) && sizeof(TextWrap) == sizeof(int), "enum props decode as int");
+
+static const PropField rect_fields[] = {
+    PROP_FIELD(FIELD_I32, RectProps, x),
+    PROP_FIELD(FIELD_I32, RectProps, y),
+    PROP_FIELD(FIELD_I32, RectProps, width),
+    PROP_FIELD(FIELD_I32, RectProps, height),
+    PROP_FIELD(FIELD_BOOL, RectProps, has_fill),
+    PROP_FIELD(FIELD_BOOL, RectProps, has_outline),
+    PROP_FIELD(FIELD_COLOR, RectProps, fill_color),
+    PROP_FIELD(FIELD_COLOR, RectProps, border_color),
+    PROP_FIELD(FIELD_F32, RectProps, border_radius),
+};
+
+static const PropField text_fields[] = {
+    PROP_FIELD(FIELD_STRING, TextProps, font_name),
+    PROP_FIELD(FIELD_I32, TextProps, font_size),
+    PROP_FIELD(FIELD_BOOL, TextProps, has_color),
+    PROP_FIELD(FIELD_COLOR, TextProps, color),
+    PROP_FIELD(FIELD_BOOL, TextProps, border),
+    PROP_FIELD(FIELD_I32, TextProps, x),
+    PROP_FIELD(FIELD_I32, TextProps, y),
+    PROP_FIELD(FIELD_I32, TextProps, width),
+    PROP_FIELD(FIELD_I32, TextProps, line_height),
+    PROP_FIELD(FIELD_I32, TextProps, align),
+    PROP_FIELD(FIELD_I32, TextProps, wrap),
+};
+
+static const PropField button_fields[] = {
+    PROP_FIELD(FIELD_I32, ButtonProps, x),
+    PROP_FIELD(FIELD_I32, ButtonProps, y),
+    PROP_FIELD(FIELD_I32, ButtonProps, width),
+    PROP_FIELD(FIELD_I32, ButtonProps, height),
+    PROP_FIELD(FIELD_COLOR, ButtonProps, color),
+    PROP_FIELD(FIELD_STRING, ButtonProps, label),
+    PROP_FIELD(FIELD_I32, ButtonProps, font_size),
+    PROP_FIELD(FIELD_F32, ButtonProps, border_radius),
+    PROP_FIELD(FIELD_COLOR, ButtonProps, text_color),
+};
+
+static const PropField scroll_fields[] = {
+    PROP_FIELD(FIELD_I32, ScrollProps, x),
+    PROP_FIELD(FIELD_I32, ScrollProps, y),
+    PROP_FIELD(FIELD_I32, ScrollProps, width),
+    PROP_FIELD(FIELD_I32, ScrollProps, height),
+    PROP_FIELD(FIELD_BOOL, ScrollProps, has_fill),
+    PROP_FIELD(FIELD_COLOR, ScrollProps, fill_color),
+    PROP_FIELD(FIELD_I32, ScrollProps, gap),
+    PROP_FIELD(FIELD_I32, ScrollProps, padding),
+};
+
+// width/height arrive as the requested size and are replaced by the resolved layout.
+// The encoder always sends image_name, width and height together.
+static const PropField image_fields[] = {
+    PROP_FIELD(FIELD_STRING, ImageProps, image_name),
+    PROP_FIELD(FIELD_I32, ImageProps, x),
+    PROP_FIELD(FIELD_I32, ImageProps, y),
+    PROP_FIELD(FIELD_I32, ImageProps, width),
+    PROP_FIELD(FIELD_I32, ImageProps, height),
+};
+
+#define IMAGE_LAYOUT_FIELDS ((1u << 0) | (1u << 3) | (1u << 4))
+
+static const PropField raw_text_fields[] = {
+    {FIELD_STRING, 0},
+};
+
+typedef struct {
+    const PropField *fields;
+    int count;
+} PropLayout;
+
+#define PROP_LAYOUT(fields) {fields, (int)(sizeof(fields) / sizeof(fields[0]))}
+
+static const PropLayout prop_layouts[] = {
+    [NT_RECT] = PROP_LAYOUT(rect_fields),
+    [NT_TEXT] = PROP_LAYOUT(text_fields),
+    [NT_BUTTON] = PROP_LAYOUT(button_fields),
+    [NT_RAW_TEXT] = PROP_LAYOUT(raw_text_fields),
+    [NT_SCROLL] = PROP_LAYOUT(scroll_fields),
+    [NT_IMAGE] = PROP_LAYOUT(image_fields),
+};
+
+static const PropLayout *prop_layout(NodeType type)
 {
-    (void)this_val;
-    if (argc < 12) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-
-    ReactInstance *inst = instance_back_find(id);
-    if (!inst || inst->type != NT_SCROLL) {
-        JS_FreeCString(ctx, id);
-        return JS_UNDEFINED;
-    }
-
-    read_scroll_props(ctx, &inst->props.scroll, argv);
-
-    JS_FreeCString(ctx, id);
-    return JS_UNDEFINED;
+    if (type <= 0 || type >= (int)(sizeof(prop_layouts) / sizeof(prop_layouts[0]))) return NULL;
+    return prop_layouts[type].fields ? &prop_layouts[type] : NULL;
 }
 
-static void read_image_props(JSContext *ctx, ImageProps *image, JSValueConst *argv, const char *image_name)
+static void release_string_props(ReactInstance *inst)
 {
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[2]);
-    image->x = tmp;
-    JS_ToInt32(ctx, &tmp, argv[3]);
-    image->y = tmp;
-    JS_ToInt32(ctx, &tmp, argv[4]);
-    int req_width = tmp;
-    JS_ToInt32(ctx, &tmp, argv[5]);
-    int req_height = tmp;
-
-    int resolved_width = 0;
-    int resolved_height = 0;
-    if (image_resolve_layout(image_name, req_width, req_height, &resolved_width, &resolved_height)) {
-        image->width = resolved_width;
-        image->height = resolved_height;
-    } else {
-        image->width = req_width > 0 ? req_width : 0;
-        image->height = req_height > 0 ? req_height : 0;
-    }
+    if (inst->type == NT_TEXT) instance_string_release(inst->props.text.font_name);
+    if (inst->type == NT_BUTTON) instance_string_release(inst->props.button.label);
+    if (inst->type == NT_RAW_TEXT) instance_string_release(inst->props.raw_text);
+    if (inst->type == NT_IMAGE) instance_string_release(inst->props.image.image_name);
 }
 
-static JSValue native_create_image(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+// Decode the fields selected by mask into inst->props. Fields not in the mask (and
+// their strings) are left untouched; replaced strings are released.
+static void read_prop_fields(MutationReader *r, ReactInstance *inst, uint32_t mask)
 {
-    (void)this_val;
-    if (argc < 6) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-    const char *image_name = JS_ToCString(ctx, argv[1]);
-    if (!image_name) {
-        JS_FreeCString(ctx, id);
-        return JS_UNDEFINED;
+    const PropLayout *layout = prop_layout(inst->type);
+    if (!layout) {
+        r->error = true;
+        return;
     }
 
-    ReactInstance *inst = calloc(1, sizeof(ReactInstance));
-    inst->id = strdup(id);
-    inst->type = NT_IMAGE;
-    inst->props.image.image_name = strdup(image_name);
-    read_image_props(ctx, &inst->props.image, argv, image_name);
-    inst->children = NULL;
-    inst->parent = NULL;
-
-    instance_back_put(inst);
-    JS_FreeCString(ctx, id);
-    JS_FreeCString(ctx, image_name);
-    return JS_UNDEFINED;
-}
-
-static JSValue native_update_image(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
-{
-    (void)this_val;
-    if (argc < 6) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-    const char *image_name = JS_ToCString(ctx, argv[1]);
-    if (!image_name) {
-        JS_FreeCString(ctx, id);
-        return JS_UNDEFINED;
+    uint8_t *base = (uint8_t *)&inst->props;
+    for (int i = 0; i < layout->count; i++) {
+        if (!(mask & (1u << i))) continue;
+        void *field = base + layout->fields[i].offset;
+        switch (layout->fields[i].kind) {
+        case FIELD_I32:
+            *(int *)field = read_i32(r);
+            break;
+        case FIELD_BOOL:
+            *(bool *)field = read_u32(r) != 0;
+            break;
+        case FIELD_F32:
+            *(float *)field = read_f32(r);
+            break;
+        case FIELD_COLOR:
+            *(Color *)field = read_color(r);
+            break;
+        case FIELD_STRING: {
+            const char *str = read_string(r);
+            instance_string_release(*(char **)field);
+            *(char **)field = instance_string_new(str ? str : "");
+            break;
+        }
+        }
     }
 
-    ReactInstance *inst = instance_back_find(id);
-    if (!inst || inst->type != NT_IMAGE) {
-        JS_FreeCString(ctx, id);
-        JS_FreeCString(ctx, image_name);
-        return JS_UNDEFINED;
+    if (inst->type == NT_IMAGE && (mask & IMAGE_LAYOUT_FIELDS)) {
+        ImageProps *image = &inst->props.image;
+        int req_width = image->width;
+        int req_height = image->height;
+        int resolved_width = 0;
+        int resolved_height = 0;
+        if (image_resolve_layout(image->image_name, req_width, req_height, &resolved_width, &resolved_height)) {
+            image->width = resolved_width;
+            image->height = resolved_height;
+        } else {
+            image->width = req_width > 0 ? req_width : 0;
+            image->height = req_height > 0 ? req_height : 0;
+        }
     }
-
-    if (inst->props.image.image_name) free(inst->props.image.image_name);
-    inst->props.image.image_name = strdup(image_name);
-    read_image_props(ctx, &inst->props.image, argv, image_name);
-
-    JS_FreeCString(ctx, id);
-    JS_FreeCString(ctx, image_name);
-    return JS_UNDEFINED;
 }
 
-static JSValue native_create_raw_text(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static void apply_create(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 2) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    const char *text = JS_ToCString(ctx, argv[1]);
-    if (!id) return JS_UNDEFINED;
-
+    InstanceHandle id = read_u32(r);
     ReactInstance *inst = calloc(1, sizeof(ReactInstance));
-    inst->id = strdup(id);
-    inst->type = NT_RAW_TEXT;
-    inst->props.raw_text = strdup(text ? text : "");
-    inst->children = NULL;
-    inst->parent = NULL;
-
-    instance_back_put(inst);
-    JS_FreeCString(ctx, id);
-    JS_FreeCString(ctx, text);
-    return JS_UNDEFINED;
+    if (!inst) {
+        TraceLog(LOG_ERROR, "[instance] out of memory creating instance %u", id);
+        r->error = true;
+        return;
+    }
+    inst->type = (NodeType)read_u32(r);
+    read_prop_fields(r, inst, UINT32_MAX);
+    if (r->error || id == INSTANCE_HANDLE_NONE) {
+        instance_back_free(inst);
+        r->error = true;
+        return;
+    }
+    inst->id = id;
+    if (!instance_back_put(inst)) {
+        TraceLog(LOG_ERROR, "[instance] create of instance %u whose handle is already live", id);
+        instance_back_free(inst);
+        r->error = true;
+    }
 }
 
-static JSValue native_append_child(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static void apply_update(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 2) return JS_UNDEFINED;
-
-    const char *parent_id = JS_ToCString(ctx, argv[0]);
-    const char *child_id = JS_ToCString(ctx, argv[1]);
-    if (!parent_id || !child_id) {
-        JS_FreeCString(ctx, parent_id);
-        JS_FreeCString(ctx, child_id);
-        return JS_UNDEFINED;
+    ReactInstance *inst = read_instance(r);
+    NodeType type = (NodeType)read_u32(r);
+    uint32_t mask = read_u32(r);
+    if (inst && inst->type == type) {
+        read_prop_fields(r, inst, mask);
+        instance_back_mark_dirty(inst);
+        return;
     }
 
-    ReactInstance *child = instance_back_find(child_id);
-    if (!child) {
-        JS_FreeCString(ctx, parent_id);
-        JS_FreeCString(ctx, child_id);
-        return JS_UNDEFINED;
-    }
+    // Unknown or mismatched instance: decode into a scratch node to stay in sync with the stream.
+    ReactInstance scratch = {.type = type};
+    read_prop_fields(r, &scratch, mask);
+    release_string_props(&scratch);
+}
 
-    if (parent_id[0] == '\0') {
+static void apply_append_child(MutationReader *r)
+{
+    InstanceHandle parent_id = read_u32(r);
+    ReactInstance *child = read_instance(r);
+    if (!child) return;
+
+    if (parent_id == INSTANCE_HANDLE_NONE) {
         instance_back_root_append(child);
     } else {
         ReactInstance *parent = instance_back_find(parent_id);
-        if (parent) {
-            child->parent = parent;
-            arrput(parent->children, child);
-        }
+        if (parent) instance_back_append_child(parent, child);
     }
-
-    JS_FreeCString(ctx, parent_id);
-    JS_FreeCString(ctx, child_id);
-    return JS_UNDEFINED;
 }
 
-static JSValue native_insert_before(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static void apply_insert_before(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 3) return JS_UNDEFINED;
-
-    const char *parent_id = JS_ToCString(ctx, argv[0]);
-    const char *child_id = JS_ToCString(ctx, argv[1]);
-    const char *before_id = JS_ToCString(ctx, argv[2]);
-
-    if (!parent_id || !child_id || !before_id) {
-        JS_FreeCString(ctx, parent_id);
-        JS_FreeCString(ctx, child_id);
-        JS_FreeCString(ctx, before_id);
-        return JS_UNDEFINED;
-    }
-
-    ReactInstance *child = instance_back_find(child_id);
-    ReactInstance *before = instance_back_find(before_id);
-    if (!child) {
-        JS_FreeCString(ctx, parent_id);
-        JS_FreeCString(ctx, child_id);
-        JS_FreeCString(ctx, before_id);
-        return JS_UNDEFINED;
-    }
+    InstanceHandle parent_id = read_u32(r);
+    ReactInstance *child = read_instance(r);
+    ReactInstance *before = read_instance(r);
+    if (!child) return;
 
-    if (parent_id[0] == '\0') {
+    if (parent_id == INSTANCE_HANDLE_NONE) {
         instance_back_root_insert(child, before);
     } else {
         ReactInstance *parent = instance_back_find(parent_id);
-        if (!parent) {
-            JS_FreeCString(ctx, parent_id);
-            JS_FreeCString(ctx, child_id);
-            JS_FreeCString(ctx, before_id);
-            return JS_UNDEFINED;
-        }
-        child->parent = parent;
-
-        int count = arrlen(parent->children);
-        int insert_idx = count;
-        for (int i = 0; i < count; i++) {
-            if (parent->children[i] == before) {
-                insert_idx = i;
-                break;
-            }
-        }
-        arrins(parent->children, insert_idx, child);
+        if (parent) instance_back_insert_child(parent, child, before);
     }
-
-    JS_FreeCString(ctx, parent_id);
-    JS_FreeCString(ctx, child_id);
-    JS_FreeCString(ctx, before_id);
-    return JS_UNDEFINED;
 }
 
-static JSValue native_remove_child(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static void apply_remove_child(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 2) return JS_UNDEFINED;
+    InstanceHandle parent_id = read_u32(r);
+    ReactInstance *child = read_instance(r);
+    if (!child) return;
 
-    const char *parent_id = JS_ToCString(ctx, argv[0]);
-    const char *child_id = JS_ToCString(ctx, argv[1]);
-
-    if (!parent_id || !child_id) {
-        JS_FreeCString(ctx, parent_id);
-        JS_FreeCString(ctx, child_id);
-        return JS_UNDEFINED;
-    }
-
-    ReactInstance *child = instance_back_find(child_id);
-    if (!child) {
-        JS_FreeCString(ctx, parent_id);
-        JS_FreeCString(ctx, child_id);
-        return JS_UNDEFINED;
-    }
-
-    if (parent_id[0] == '\0') {
+    if (parent_id == INSTANCE_HANDLE_NONE) {
         instance_back_root_remove(child);
     } else {
         ReactInstance *parent = instance_back_find(parent_id);
-        if (!parent) {
-            JS_FreeCString(ctx, parent_id);
-            JS_FreeCString(ctx, child_id);
-            return JS_UNDEFINED;
-        }
-
-        int count = arrlen(parent->children);
-        for (int i = 0; i < count; i++) {
-            if (parent->children[i] == child) {
-                arrdel(parent->children, i);
-                break;
-            }
-        }
+        if (parent) instance_back_remove_child(parent, child);
     }
-
-    child->parent = NULL;
-    JS_FreeCString(ctx, parent_id);
-    JS_FreeCString(ctx, child_id);
-    return JS_UNDEFINED;
 }
 
-static JSValue native_destroy_instance(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static void apply_destroy(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 1) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-
+    InstanceHandle id = read_u32(r);
     ReactInstance *inst = instance_back_find(id);
-    if (!inst) {
-        JS_FreeCString(ctx, id);
-        return JS_UNDEFINED;
-    }
+    if (!inst) return;
 
     instance_back_del(id);
     instance_back_free(inst);
-
-    JS_FreeCString(ctx, id);
-    return JS_UNDEFINED;
 }
 
-static JSValue native_update_rect(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static void apply_mutations(MutationReader *r)
 {
-    (void)this_val;
-    if (argc < 16) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-
-    ReactInstance *inst = instance_back_find(id);
-    if (!inst || inst->type != NT_RECT) {
-        JS_FreeCString(ctx, id);
-        return JS_UNDEFINED;
-    }
-
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[1]);
-    inst->props.rect.x = tmp;
-    JS_ToInt32(ctx, &tmp, argv[2]);
-    inst->props.rect.y = tmp;
-    JS_ToInt32(ctx, &tmp, argv[3]);
-    inst->props.rect.width = tmp;
-    JS_ToInt32(ctx, &tmp, argv[4]);
-    inst->props.rect.height = tmp;
-    inst->props.rect.has_fill = JS_ToBool(ctx, argv[5]);
-    if (inst->props.rect.has_fill) {
-        int32_t r, g, b, a;
-        JS_ToInt32(ctx, &r, argv[6]);
-        JS_ToInt32(ctx, &g, argv[7]);
-        JS_ToInt32(ctx, &b, argv[8]);
-        JS_ToInt32(ctx, &a, argv[9]);
-        inst->props.rect.fill_color = (Color){r, g, b, a};
-    }
-    inst->props.rect.has_outline = JS_ToBool(ctx, argv[10]);
-    if (inst->props.rect.has_outline) {
-        int32_t r, g, b, a;
-        JS_ToInt32(ctx, &r, argv[11]);
-        JS_ToInt32(ctx, &g, argv[12]);
-        JS_ToInt32(ctx, &b, argv[13]);
-        JS_ToInt32(ctx, &a, argv[14]);
-        inst->props.rect.border_color = (Color){r, g, b, a};
+    while (!r->error && r->pos < r->size) {
+        mutation_stats.ops++;
+        MutationOp op = (MutationOp)read_u32(r);
+        switch (op) {
+        case MUT_CREATE:
+            apply_create(r);
+            break;
+        case MUT_UPDATE:
+            apply_update(r);
+            break;
+        case MUT_APPEND_CHILD:
+            apply_append_child(r);
+            break;
+        case MUT_INSERT_BEFORE:
+            apply_insert_before(r);
+            break;
+        case MUT_REMOVE_CHILD:
+            apply_remove_child(r);
+            break;
+        case MUT_DESTROY:
+            apply_destroy(r);
+            break;
+        case MUT_CLEAR_CONTAINER:
+            instance_back_root_clear();
+            break;
+        default:
+            r->error = true;
+            break;
+        }
     }
-    double border_radius;
-    JS_ToFloat64(ctx, &border_radius, argv[15]);
-    inst->props.rect.border_radius = (float)border_radius;
-
-    JS_FreeCString(ctx, id);
-    return JS_UNDEFINED;
 }
 
-static JSValue native_update_text(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+// nativeApplyMutations(buffer: ArrayBuffer, byteLength: number, strings: string[])
+static JSValue native_apply_mutations(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
 {
     (void)this_val;
-    if (argc < 15) return JS_UNDEFINED;
+    if (argc < 3) return JS_ThrowTypeError(ctx, "nativeApplyMutations requires a buffer, length and string table");
 
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-    const char *font_name = JS_ToCString(ctx, argv[1]);
+    size_t buffer_size = 0;
+    uint8_t *data = JS_GetArrayBuffer(ctx, &buffer_size, argv[0]);
+    if (!data) return JS_EXCEPTION;
 
-    ReactInstance *inst = instance_back_find(id);
-    if (!inst || inst->type != NT_TEXT) {
-        JS_FreeCString(ctx, id);
-        JS_FreeCString(ctx, font_name);
-        return JS_UNDEFINED;
+    int64_t byte_length = 0;
+    JS_ToInt64(ctx, &byte_length, argv[1]);
+    if (byte_length < 0 || (uint64_t)byte_length > buffer_size) {
+        return JS_ThrowRangeError(ctx, "nativeApplyMutations byteLength out of range");
     }
 
-    if (inst->props.text.font_name) free(inst->props.text.font_name);
-    inst->props.text.font_name = strdup(font_name ? font_name : "default");
-
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[2]);
-    inst->props.text.font_size = tmp;
-    inst->props.text.has_color = JS_ToBool(ctx, argv[3]);
-    if (inst->props.text.has_color) {
-        int32_t r, g, b, a;
-        JS_ToInt32(ctx, &r, argv[4]);
-        JS_ToInt32(ctx, &g, argv[5]);
-        JS_ToInt32(ctx, &b, argv[6]);
-        JS_ToInt32(ctx, &a, argv[7]);
-        inst->props.text.color = (Color){r, g, b, a};
+    int64_t string_count = 0;
+    JSValue length_val = JS_GetPropertyStr(ctx, argv[2], "length");
+    JS_ToInt64(ctx, &string_count, length_val);
+    JS_FreeValue(ctx, length_val);
+
+    const char **strings = NULL;
+    if (string_count > 0) arrsetlen(strings, string_count);
+    for (int64_t i = 0; i < string_count; i++) {
+        JSValue str_val = JS_GetPropertyUint32(ctx, argv[2], (uint32_t)i);
+        strings[i] = JS_ToCString(ctx, str_val);
+        JS_FreeValue(ctx, str_val);
     }
-    inst->props.text.border = JS_ToBool(ctx, argv[8]);
-    read_text_layout_props(ctx, &inst->props.text, argv, 9);
-
-    JS_FreeCString(ctx, font_name);
-    JS_FreeCString(ctx, id);
-    return JS_UNDEFINED;
-}
-
-static JSValue native_update_button(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
-{
-    (void)this_val;
-    if (argc < 16) return JS_UNDEFINED;
 
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-
-    ReactInstance *inst = instance_back_find(id);
-    if (!inst || inst->type != NT_BUTTON) {
-        JS_FreeCString(ctx, id);
-        return JS_UNDEFINED;
+    MutationReader reader = {
+        .data = data,
+        .size = (size_t)byte_length,
+        .strings = strings,
+        .string_count = (uint32_t)string_count,
+    };
+    mutation_stats.batches++;
+    apply_mutations(&reader);
+    if (reader.error) {
+        TraceLog(LOG_ERROR, "[instance] malformed mutation buffer at byte %zu of %zu", reader.pos, reader.size);
     }
 
-    int32_t tmp;
-    JS_ToInt32(ctx, &tmp, argv[1]);
-    inst->props.button.x = tmp;
-    JS_ToInt32(ctx, &tmp, argv[2]);
-    inst->props.button.y = tmp;
-    JS_ToInt32(ctx, &tmp, argv[3]);
-    inst->props.button.width = tmp;
-    JS_ToInt32(ctx, &tmp, argv[4]);
-    inst->props.button.height = tmp;
-
-    int32_t r, g, b, a;
-    JS_ToInt32(ctx, &r, argv[5]);
-    JS_ToInt32(ctx, &g, argv[6]);
-    JS_ToInt32(ctx, &b, argv[7]);
-    JS_ToInt32(ctx, &a, argv[8]);
-    inst->props.button.color = (Color){r, g, b, a};
-
-    if (inst->props.button.label) free(inst->props.button.label);
-    const char *label = JS_ToCString(ctx, argv[9]);
-    inst->props.button.label = strdup(label ? label : "");
-    JS_FreeCString(ctx, label);
-
-    JS_ToInt32(ctx, &tmp, argv[10]);
-    inst->props.button.font_size = tmp;
-
-    double border_radius;
-    JS_ToFloat64(ctx, &border_radius, argv[11]);
-    inst->props.button.border_radius = (float)border_radius;
-
-    int32_t tr, tg, tb, ta;
-    JS_ToInt32(ctx, &tr, argv[12]);
-    JS_ToInt32(ctx, &tg, argv[13]);
-    JS_ToInt32(ctx, &tb, argv[14]);
-    JS_ToInt32(ctx, &ta, argv[15]);
-    inst->props.button.text_color = (Color){tr, tg, tb, ta};
-
-    JS_FreeCString(ctx, id);
-    return JS_UNDEFINED;
-}
-
-static JSValue native_update_raw_text(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
-{
-    (void)this_val;
-    if (argc < 2) return JS_UNDEFINED;
-
-    const char *id = JS_ToCString(ctx, argv[0]);
-    if (!id) return JS_UNDEFINED;
-
-    ReactInstance *inst = instance_back_find(id);
-    if (!inst || inst->type != NT_RAW_TEXT) {
-        JS_FreeCString(ctx, id);
-        return JS_UNDEFINED;
+    for (int64_t i = 0; i < string_count; i++) {
+        JS_FreeCString(ctx, strings[i]);
     }
-
-    if (inst->props.raw_text) free(inst->props.raw_text);
-    const char *text = JS_ToCString(ctx, argv[1]);
-    inst->props.raw_text = strdup(text ? text : "");
-    JS_FreeCString(ctx, text);
-
-    JS_FreeCString(ctx, id);
+    arrfree(strings);
     return JS_UNDEFINED;
 }
 
-static JSValue native_clear_container(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+static JSValue native_commit(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
 {
     (void)ctx;
     (void)this_val;
     (void)argc;
     (void)argv;
-    instance_back_root_clear();
+    instance_tree_commit();
     return JS_UNDEFINED;
 }
 
+void get_mutation_stats(MutationStats *out)
+{
+    *out = mutation_stats;
+}
+
 void register_instance_tree(JSContext *ctx)
 {
-    js_set_global_function(ctx, "nativeCreateRect", native_create_rect, 16);
-    js_set_global_function(ctx, "nativeCreateText", native_create_text, 15);
-    js_set_global_function(ctx, "nativeCreateButton", native_create_button, 16);
-    js_set_global_function(ctx, "nativeCreateScroll", native_create_scroll, 12);
-    js_set_global_function(ctx, "nativeCreateImage", native_create_image, 6);
-    js_set_global_function(ctx, "nativeCreateRawText", native_create_raw_text, 2);
-    js_set_global_function(ctx, "nativeAppendChild", native_append_child, 2);
-    js_set_global_function(ctx, "nativeInsertBefore", native_insert_before, 3);
-    js_set_global_function(ctx, "nativeRemoveChild", native_remove_child, 2);
-    js_set_global_function(ctx, "nativeDestroyInstance", native_destroy_instance, 1);
-    js_set_global_function(ctx, "nativeUpdateRect", native_update_rect, 16);
-    js_set_global_function(ctx, "nativeUpdateText", native_update_text, 15);
-    js_set_global_function(ctx, "nativeUpdateButton", native_update_button, 16);
-    js_set_global_function(ctx, "nativeUpdateScroll", native_update_scroll, 12);
-    js_set_global_function(ctx, "nativeUpdateImage", native_update_image, 6);
-    js_set_global_function(ctx, "nativeUpdateRawText", native_update_raw_text, 2);
-    js_set_global_function(ctx, "nativeClearContainer", native_clear_container, 0);
+    js_set_global_function(ctx, "nativeApplyMutations", native_apply_mutations, 3);
+    js_set_global_function(ctx, "nativeCommit", native_commit, 0);
 }
@@ -1,6 +1,8 @@
 #include "jslib_internal.h"
 #include "core/event_queue.h"
+#include "core/latency.h"
 #include "core/package_library.h"
+#include "core/profiler.h"
 
 static JSValue js_get_time(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
 {
@@ -10,6 +12,77 @@ static JSValue js_get_time(JSContext *ctx, JSValueConst this_val, int argc, JSVa
     return JS_NewFloat64(ctx, GetTime());
 }
 
+// { [stage]: { count, meanMs, p50Ms, p95Ms, p99Ms, maxMs } } for every input latency stage.
+static JSValue js_native_get_input_latency(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    (void)this_val;
+    (void)argc;
+    (void)argv;
+    JSValue result = JS_NewObject(ctx);
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        LatencyStats stats;
+        latency_get_stats((LatencyStage)stage, &stats);
+        JSValue entry = JS_NewObject(ctx);
+        JS_SetPropertyStr(ctx, entry, "count", JS_NewInt32(ctx, stats.count));
+        JS_SetPropertyStr(ctx, entry, "meanMs", JS_NewFloat64(ctx, stats.mean_ms));
+        JS_SetPropertyStr(ctx, entry, "p50Ms", JS_NewFloat64(ctx, stats.p50_ms));
+        JS_SetPropertyStr(ctx, entry, "p95Ms", JS_NewFloat64(ctx, stats.p95_ms));
+        JS_SetPropertyStr(ctx, entry, "p99Ms", JS_NewFloat64(ctx, stats.p99_ms));
+        JS_SetPropertyStr(ctx, entry, "maxMs", JS_NewFloat64(ctx, stats.max_ms));
+        JS_SetPropertyStr(ctx, result, latency_stage_name((LatencyStage)stage), entry);
+    }
+    return result;
+}
+
+static JSValue js_native_reset_input_latency(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    (void)ctx;
+    (void)this_val;
+    (void)argc;
+    (void)argv;
+    latency_reset();
+    return JS_UNDEFINED;
+}
+
+static JSValue js_native_profile_start(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    (void)this_val;
+    (void)argc;
+    (void)argv;
+    return JS_NewBool(ctx, prof_start());
+}
+
+// Ends the capture and returns the path of the written trace.
+static JSValue js_native_profile_stop(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    (void)this_val;
+    const char *path = argc >= 1 && JS_IsString(argv[0]) ? JS_ToCString(ctx, argv[0]) : NULL;
+    char error[256];
+    if (!prof_stop(path, error, sizeof(error))) {
+        if (path) JS_FreeCString(ctx, path);
+        return JS_ThrowInternalError(ctx, "%s", error);
+    }
+    JSValue result = JS_NewString(ctx, path ? path : prof_default_path());
+    if (path) JS_FreeCString(ctx, path);
+    return result;
+}
+
+// A zone timed in JS: name, start and duration in milliseconds on the getTime() clock.
+static JSValue js_native_profile_zone(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+    (void)this_val;
+    if (argc < 3 || !prof_capturing()) return JS_UNDEFINED;
+
+    double start_ms = 0.0;
+    double duration_ms = 0.0;
+    if (JS_ToFloat64(ctx, &start_ms, argv[1]) || JS_ToFloat64(ctx, &duration_ms, argv[2])) return JS_EXCEPTION;
+    const char *name = JS_ToCString(ctx, argv[0]);
+    if (!name) return JS_EXCEPTION;
+    prof_zone(PROF_THREAD_JS, 0, prof_intern(name), start_ms / 1000.0, duration_ms / 1000.0);
+    JS_FreeCString(ctx, name);
+    return JS_UNDEFINED;
+}
+
 static char *jslib_read_file(const char *filename, size_t *out_len)
 {
     FILE *f = fopen(filename, "rb");
@@ -79,16 +152,73 @@ static JSValue js_native_get_active_deck_app_path(JSContext *ctx, JSValueConst t
     return JS_NewString(ctx, package_library_active_package_path());
 }
 
-static void call_input_event_from_native(JSContext *ctx, const char *id, const char *event)
+// vitadeck.input and its batch dispatcher, looked up once per runtime.
+static JSValue input_object;
+static JSValue input_dispatch;
+static bool input_dispatch_cached = false;
+
+static bool resolve_input_dispatch(JSContext *ctx)
 {
+    if (input_dispatch_cached) return true;
+
     JSValue global = JS_GetGlobalObject(ctx);
     JSValue vitadeck = JS_GetPropertyStr(ctx, global, "vitadeck");
     JSValue input = JS_GetPropertyStr(ctx, vitadeck, "input");
-    JSValue fn = JS_GetPropertyStr(ctx, input, "onInputEventFromNative");
+    JSValue fn = JS_GetPropertyStr(ctx, input, "onInputEventsFromNative");
+    JS_FreeValue(ctx, vitadeck);
+    JS_FreeValue(ctx, global);
 
-    JSValue args[2] = {JS_NewString(ctx, id), JS_NewString(ctx, event)};
+    if (!JS_IsFunction(ctx, fn)) {
+        JS_FreeValue(ctx, fn);
+        JS_FreeValue(ctx, input);
+        return false;
+    }
+    input_object = input;
+    input_dispatch = fn;
+    input_dispatch_cached = true;
+    return true;
+}
 
-    JSValue result = JS_Call(ctx, fn, input, 2, args);
+// Events are handed to JS as one Float64Array-compatible buffer of (target, kind, time) triples.
+#define INPUT_EVENT_STRIDE 3
+
+// Reused across calls so a frame's batch does not allocate.
+static double *input_batch = NULL;
+
+void process_input_events(JSContext *ctx)
+{
+    arrsetlen(input_batch, 0);
+
+    double dequeued_at = GetTime();
+    double oldest_press = 0.0;
+    bool has_press = false;
+
+    InputEvent evt;
+    while (event_queue_pop(&evt)) {
+        if (evt.type != EVT_INPUT) continue;
+        if (evt.kind == INPUT_MOUSEDOWN || evt.kind == INPUT_MOUSEUP || evt.kind == INPUT_CLICK) {
+            if (!has_press || evt.time < oldest_press) oldest_press = evt.time;
+            has_press = true;
+        }
+        double *slot = arraddnptr(input_batch, INPUT_EVENT_STRIDE);
+        slot[0] = (double)evt.target;
+        slot[1] = (double)evt.kind;
+        slot[2] = evt.time;
+    }
+
+    unsigned int dropped = event_queue_take_dropped();
+    if (dropped > 0) TraceLog(LOG_WARNING, "[input] Dropped %u input events, queue was full", dropped);
+
+    if (arrlen(input_batch) == 0) return;
+    if (!resolve_input_dispatch(ctx)) {
+        TraceLog(LOG_ERROR, "Error calling input event from native: vitadeck.input.onInputEventsFromNative missing");
+        return;
+    }
+
+    if (has_press) latency_input_begin(oldest_press, dequeued_at);
+    JSValue events = JS_NewArrayBufferCopy(ctx, (const uint8_t *)input_batch, arrlen(input_batch) * sizeof(double));
+    JSValue result = JS_Call(ctx, input_dispatch, input_object, 1, &events);
+    if (has_press) latency_input_end();
 
     if (JS_IsException(result)) {
         JSValue exc = JS_GetException(ctx);
@@ -99,22 +229,16 @@ static void call_input_event_from_native(JSContext *ctx, const char *id, const c
     }
 
     JS_FreeValue(ctx, result);
-    JS_FreeValue(ctx, args[0]);
-    JS_FreeValue(ctx, args[1]);
-    JS_FreeValue(ctx, fn);
-    JS_FreeValue(ctx, input);
-    JS_FreeValue(ctx, vitadeck);
-    JS_FreeValue(ctx, global);
+    JS_FreeValue(ctx, events);
 }
 
-void process_input_events(JSContext *ctx)
+void input_events_shutdown(JSContext *ctx)
 {
-    InputEvent evt;
-    while (event_queue_pop(&evt)) {
-        if (evt.type == EVT_INPUT) {
-            call_input_event_from_native(ctx, evt.id, evt.event_name);
-        }
-    }
+    arrfree(input_batch);
+    if (!input_dispatch_cached) return;
+    JS_FreeValue(ctx, input_dispatch);
+    JS_FreeValue(ctx, input_object);
+    input_dispatch_cached = false;
 }
 
 void register_js_lib(JSContext *ctx)
@@ -129,4 +253,9 @@ void register_js_lib(JSContext *ctx)
     js_set_global_function(ctx, "nativeReadTextFile", js_native_read_text_file, 1);
     js_set_global_function(ctx, "nativeEvalFile", js_native_eval_file, 1);
     js_set_global_function(ctx, "nativeGetActiveDeckAppPath", js_native_get_active_deck_app_path, 0);
+    js_set_global_function(ctx, "nativeGetInputLatency", js_native_get_input_latency, 0);
+    js_set_global_function(ctx, "nativeResetInputLatency", js_native_reset_input_latency, 0);
+    js_set_global_function(ctx, "nativeProfileStart", js_native_profile_start, 0);
+    js_set_global_function(ctx, "nativeProfileStop", js_native_profile_stop, 1);
+    js_set_global_function(ctx, "nativeProfileZone", js_native_profile_zone, 3);
 }
@@ -5,8 +5,19 @@
 
 void register_js_lib(JSContext *ctx);
 void process_input_events(JSContext *ctx);
+// Drop the cached JS input dispatcher (before freeing ctx).
+void input_events_shutdown(JSContext *ctx);
 void run_timeouts(JSContext *ctx);
 void timeout_shutdown(JSContext *ctx);
+// Milliseconds until the earliest timer is due (0 if one is due now), capped at max_ms.
+int timeout_next_delay_ms(int max_ms);
+// Running totals of nativeApplyMutations calls and the operations they carried (JS thread).
+typedef struct {
+    unsigned long batches;
+    unsigned long ops;
+} MutationStats;
+
+void get_mutation_stats(MutationStats *out);
 void run_fetch(JSContext *ctx);
 void fetch_shutdown(JSContext *ctx);
 
@@ -5,13 +5,84 @@ typedef struct {
     double next_scheduled_at;
     unsigned int id;
     int interval_ms;
+    unsigned int seq; // insertion order, breaks ties so equal deadlines fire FIFO
 } TimeoutItem;
 
+// Binary min-heap ordered by (next_scheduled_at, seq), plus id -> heap index.
+// A timer whose callback is running is out of the heap and maps to TIMER_RUNNING.
+static TimeoutItem *timer_heap = NULL;
 static struct {
     unsigned int key;
-    TimeoutItem value;
-} *timeout_hm = NULL;
+    int value;
+} *timer_index = NULL;
 static unsigned int timeout_id_counter = 1;
+static unsigned int timer_seq = 0;
+static bool running_cleared = false;
+
+#define TIMER_RUNNING -1
+
+static bool timer_before(const TimeoutItem *a, const TimeoutItem *b)
+{
+    if (a->next_scheduled_at != b->next_scheduled_at) return a->next_scheduled_at < b->next_scheduled_at;
+    return (int)(a->seq - b->seq) < 0;
+}
+
+static void heap_set(int i, TimeoutItem item)
+{
+    timer_heap[i] = item;
+    hmput(timer_index, item.id, i);
+}
+
+static void heap_sift_up(int i)
+{
+    TimeoutItem item = timer_heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!timer_before(&item, &timer_heap[parent])) break;
+        heap_set(i, timer_heap[parent]);
+        i = parent;
+    }
+    heap_set(i, item);
+}
+
+static void heap_sift_down(int i)
+{
+    int count = (int)arrlen(timer_heap);
+    TimeoutItem item = timer_heap[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= count) break;
+        if (child + 1 < count && timer_before(&timer_heap[child + 1], &timer_heap[child])) child++;
+        if (!timer_before(&timer_heap[child], &item)) break;
+        heap_set(i, timer_heap[child]);
+        i = child;
+    }
+    heap_set(i, item);
+}
+
+static void heap_push(TimeoutItem item)
+{
+    item.seq = timer_seq++;
+    arrput(timer_heap, item);
+    heap_sift_up((int)arrlen(timer_heap) - 1);
+}
+
+// Remove and return the item at heap index i; its id stays out of timer_index.
+static TimeoutItem heap_remove_at(int i)
+{
+    TimeoutItem removed = timer_heap[i];
+    TimeoutItem last = arrpop(timer_heap);
+    hmdel(timer_index, removed.id);
+    if (i < (int)arrlen(timer_heap)) {
+        timer_heap[i] = last;
+        if (i > 0 && timer_before(&last, &timer_heap[(i - 1) / 2])) {
+            heap_sift_up(i);
+        } else {
+            heap_sift_down(i);
+        }
+    }
+    return removed;
+}
 
 static JSValue set_timeout_impl(JSContext *ctx, int argc, JSValueConst *argv, bool is_interval)
 {
@@ -28,20 +99,20 @@ static JSValue set_timeout_impl(JSContext *ctx, int argc, JSValueConst *argv, bo
     }
     double delay_in_seconds = delay_in_ms / 1000.0;
 
-    while (timeout_id_counter == 0 || hmgeti(timeout_hm, timeout_id_counter) >= 0) {
+    while (timeout_id_counter == 0 || hmgeti(timer_index, timeout_id_counter) >= 0) {
         timeout_id_counter++;
     }
 
     TimeoutItem item = {.func = func,
                         .next_scheduled_at = GetTime() + delay_in_seconds,
-                        .id = timeout_id_counter,
+                        .id = timeout_id_counter++,
                         .interval_ms = is_interval ? delay_in_ms : -1};
 
-    hmput(timeout_hm, item.id, item);
+    heap_push(item);
 
     TraceLog(LOG_DEBUG, "[%s] ID: %u, delay: %d ms, scheduled at %f, queue length: %td",
              is_interval ? "setInterval" : "setTimeout", item.id, delay_in_ms, item.next_scheduled_at,
-             hmlen(timeout_hm));
+             arrlen(timer_heap));
 
     return JS_NewInt32(ctx, item.id);
 }
@@ -66,14 +137,20 @@ static JSValue js_clear_timeout(JSContext *ctx, JSValueConst this_val, int argc,
     int32_t id;
     JS_ToInt32(ctx, &id, argv[0]);
 
-    if (hmgeti(timeout_hm, id) < 0) {
+    int idx = hmgeti(timer_index, id);
+    if (idx < 0) {
         TraceLog(LOG_DEBUG, "[clearTimeout/clearInterval] Timeout with ID: %d not found, ignoring", id);
         return JS_UNDEFINED;
     }
 
-    TimeoutItem item = hmget(timeout_hm, id);
-    hmdel(timeout_hm, id);
-    JS_FreeValue(ctx, item.func);
+    int heap_idx = timer_index[idx].value;
+    if (heap_idx == TIMER_RUNNING) {
+        // Cleared from inside its own callback; run_timeouts frees it afterwards.
+        running_cleared = true;
+    } else {
+        TimeoutItem item = heap_remove_at(heap_idx);
+        JS_FreeValue(ctx, item.func);
+    }
 
     TraceLog(LOG_DEBUG, "[clearTimeout/clearInterval] Cleared timeout with ID: %d", id);
     return JS_UNDEFINED;
@@ -86,20 +163,15 @@ void run_timeouts(JSContext *ctx)
     double current_time = GetTime();
     tick_count++;
 
-    unsigned int *expired_ids = NULL;
-    for (int i = 0; i < hmlen(timeout_hm); i++) {
-        TimeoutItem item = timeout_hm[i].value;
-        if (item.next_scheduled_at <= current_time) {
-            arrput(expired_ids, item.id);
-        }
-    }
-
-    for (size_t j = 0; j < arrlen(expired_ids); j++) {
-        unsigned int id = expired_ids[j];
-        int idx = hmgeti(timeout_hm, id);
-        if (idx < 0) continue;
+    // Timers added or rescheduled during this pass wait for the next one.
+    unsigned int pass_seq = timer_seq;
+    while (arrlen(timer_heap) > 0) {
+        TimeoutItem *top = &timer_heap[0];
+        if (top->next_scheduled_at > current_time || (int)(top->seq - pass_seq) >= 0) break;
 
-        TimeoutItem item = timeout_hm[idx].value;
+        TimeoutItem item = heap_remove_at(0);
+        hmput(timer_index, item.id, TIMER_RUNNING);
+        running_cleared = false;
 
         JSValue global = JS_GetGlobalObject(ctx);
         JSValue result = JS_Call(ctx, item.func, global, 0, NULL);
@@ -108,24 +180,32 @@ void run_timeouts(JSContext *ctx)
         if (JS_IsException(result)) {
             JSValue exc = JS_GetException(ctx);
             const char *str = JS_ToCString(ctx, exc);
-            TraceLog(LOG_ERROR, "[run_timeouts] %u ID: %u Error: %s", tick_count, id, str ? str : "unknown");
+            TraceLog(LOG_ERROR, "[run_timeouts] %u ID: %u Error: %s", tick_count, item.id, str ? str : "unknown");
             JS_FreeCString(ctx, str);
             JS_FreeValue(ctx, exc);
         } else {
-            TraceLog(LOG_DEBUG, "[run_timeouts] %u ID: %u executed", tick_count, id);
+            TraceLog(LOG_DEBUG, "[run_timeouts] %u ID: %u executed", tick_count, item.id);
         }
         JS_FreeValue(ctx, result);
 
-        if (item.interval_ms >= 0) {
+        hmdel(timer_index, item.id);
+        if (item.interval_ms >= 0 && !running_cleared) {
             item.next_scheduled_at = GetTime() + item.interval_ms / 1000.0;
-            hmput(timeout_hm, item.id, item);
+            heap_push(item);
         } else {
-            hmdel(timeout_hm, item.id);
             JS_FreeValue(ctx, item.func);
         }
     }
+}
+
+int timeout_next_delay_ms(int max_ms)
+{
+    if (arrlen(timer_heap) == 0) return max_ms;
 
-    arrfree(expired_ids);
+    double delay_ms = (timer_heap[0].next_scheduled_at - GetTime()) * 1000.0;
+    if (delay_ms <= 0.0) return 0;
+    if (delay_ms >= max_ms) return max_ms;
+    return (int)delay_ms + 1; // round up so the timer is due when we wake
 }
 
 void register_js_timeout(JSContext *ctx)
@@ -138,10 +218,13 @@ void register_js_timeout(JSContext *ctx)
 
 void timeout_shutdown(JSContext *ctx)
 {
-    for (int i = 0; i < hmlen(timeout_hm); i++) {
-        JS_FreeValue(ctx, timeout_hm[i].value.func);
+    for (int i = 0; i < arrlen(timer_heap); i++) {
+        JS_FreeValue(ctx, timer_heap[i].func);
     }
-    hmfree(timeout_hm);
-    timeout_hm = NULL;
+    arrfree(timer_heap);
+    timer_heap = NULL;
+    hmfree(timer_index);
+    timer_index = NULL;
     timeout_id_counter = 1;
+    timer_seq = 0;
 }
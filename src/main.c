@@ -4,6 +4,8 @@
 #include "stb_ds.h"
 #include "core/bootstrap.h"
 #include "core/js_runtime.h"
+#include "core/latency.h"
+#include "core/perf.h"
 #include "core/package_library.h"
 #include "shell/shell.h"
 #include "ui/input.h"
@@ -78,23 +80,33 @@ int main(int argc, char *argv[])
 
         if (!shell_is_visible(&shell) && package_library_has_active_deck_app() &&
             js_runtime_is_ready(&bootstrap.js_runtime)) {
+            double input_start = perf_begin();
             poll_mouse_input();
             poll_touch_input();
             poll_gamepad_input();
+            input_flush_events();
+            perf_end(PERF_UI_INPUT, input_start);
         }
 
         BeginDrawing();
         ClearBackground(BLACK);
         bootstrap_draw_deck_canvas(&bootstrap);
         draw_shell_runtime_recovery_hint(&bootstrap);
+        double shell_start = perf_begin();
         shell_render(&shell);
-        DrawFPS(VD_SCREEN_WIDTH - 100, 10);
+        perf_end(PERF_UI_SHELL, shell_start);
+        if (shell_perf_overlay_visible(&shell)) perf_hud_draw(VD_SCREEN_WIDTH - 348, 10);
 
         for (int i = 0; i < GetTouchPointCount(); i++) {
             Vector2 position = GetTouchPosition(i);
             DrawCircle(position.x, position.y, 10, RED);
         }
+        double present_start = perf_begin();
         EndDrawing();
+        perf_end(PERF_UI_PRESENT, present_start);
+        latency_presented();
+        perf_ui_frame_end();
+        perf_set_enabled(shell_perf_overlay_visible(&shell));
     }
 
 defer:
@@ -1,8 +1,11 @@
 #ifndef VD_THREAD_H
 #define VD_THREAD_H
 
+#include <stdbool.h>
+
 typedef struct vd_thread vd_thread;
 typedef struct vd_mutex vd_mutex;
+typedef struct vd_event vd_event;
 
 // Thread
 vd_thread *vd_thread_create(void *(*func)(void *), void *arg);
@@ -16,4 +19,11 @@ void vd_mutex_lock(vd_mutex *m);
 void vd_mutex_unlock(vd_mutex *m);
 void vd_mutex_destroy(vd_mutex *m);
 
+// Event (auto-reset): signal wakes one waiter, or the next wait if nobody is waiting.
+// Wait returns true when signaled, false on timeout; timeout_ms < 0 waits forever.
+vd_event *vd_event_create(void);
+void vd_event_signal(vd_event *e);
+bool vd_event_wait(vd_event *e, int timeout_ms);
+void vd_event_destroy(vd_event *e);
+
 #endif /* VD_THREAD_H */
@@ -1,9 +1,11 @@
 #ifndef __vita__
 
 #include "thread.h"
+#include <errno.h>
 #include <pthread.h>
 #include <stdlib.h>
 #include <sched.h>
+#include <time.h>
 
 struct vd_thread {
     pthread_t handle;
@@ -13,6 +15,12 @@ struct vd_mutex {
     pthread_mutex_t handle;
 };
 
+struct vd_event {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool signaled;
+};
+
 vd_thread *vd_thread_create(void *(*func)(void *), void *arg)
 {
     vd_thread *t = malloc(sizeof(vd_thread));
@@ -68,4 +76,93 @@ void vd_mutex_destroy(vd_mutex *m)
     }
 }
 
+vd_event *vd_event_create(void)
+{
+    vd_event *e = malloc(sizeof(vd_event));
+    if (!e) return NULL;
+    if (pthread_mutex_init(&e->mutex, NULL) != 0) {
+        free(e);
+        return NULL;
+    }
+    // Timed waits measure against CLOCK_MONOTONIC so wall-clock changes do not skew them. macOS has no
+    // pthread_condattr_setclock; vd_event_wait uses a relative timed wait there instead.
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#ifndef __APPLE__
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    int rc = pthread_cond_init(&e->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (rc != 0) {
+        pthread_mutex_destroy(&e->mutex);
+        free(e);
+        return NULL;
+    }
+    e->signaled = false;
+    return e;
+}
+
+void vd_event_signal(vd_event *e)
+{
+    if (!e) return;
+    pthread_mutex_lock(&e->mutex);
+    e->signaled = true;
+    pthread_cond_signal(&e->cond);
+    pthread_mutex_unlock(&e->mutex);
+}
+
+static int timed_wait(vd_event *e, const struct timespec *deadline)
+{
+#ifdef __APPLE__
+    // Relative wait for the time left until the monotonic deadline, recomputed after spurious wakeups.
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    struct timespec left = {deadline->tv_sec - now.tv_sec, deadline->tv_nsec - now.tv_nsec};
+    if (left.tv_nsec < 0) {
+        left.tv_sec--;
+        left.tv_nsec += 1000000000L;
+    }
+    if (left.tv_sec < 0) return ETIMEDOUT;
+    return pthread_cond_timedwait_relative_np(&e->cond, &e->mutex, &left);
+#else
+    return pthread_cond_timedwait(&e->cond, &e->mutex, deadline);
+#endif
+}
+
+bool vd_event_wait(vd_event *e, int timeout_ms)
+{
+    if (!e) return false;
+
+    // Absolute CLOCK_MONOTONIC deadline, the clock the condition variable was created with
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&e->mutex);
+    while (!e->signaled) {
+        int rc = timeout_ms < 0 ? pthread_cond_wait(&e->cond, &e->mutex) : timed_wait(e, &deadline);
+        if (rc != 0) break;
+    }
+    bool signaled = e->signaled;
+    e->signaled = false;
+    pthread_mutex_unlock(&e->mutex);
+    return signaled;
+}
+
+void vd_event_destroy(vd_event *e)
+{
+    if (e) {
+        pthread_cond_destroy(&e->cond);
+        pthread_mutex_destroy(&e->mutex);
+        free(e);
+    }
+}
+
 #endif /* !__vita__ */
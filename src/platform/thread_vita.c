@@ -16,6 +16,11 @@ struct vd_mutex {
     SceUID mid;
 };
 
+// Binary semaphore (max count 1) gives auto-reset event semantics.
+struct vd_event {
+    SceUID sid;
+};
+
 static int vita_thread_entry(SceSize args, void *argp)
 {
     vd_thread *t = *(vd_thread **)argp;
@@ -108,4 +113,45 @@ void vd_mutex_destroy(vd_mutex *m)
     }
 }
 
+vd_event *vd_event_create(void)
+{
+    vd_event *e = malloc(sizeof(vd_event));
+    if (!e) return NULL;
+
+    e->sid = sceKernelCreateSema("VdEvent", 0, 0, 1, NULL);
+    if (e->sid < 0) {
+        free(e);
+        return NULL;
+    }
+
+    return e;
+}
+
+void vd_event_signal(vd_event *e)
+{
+    // Fails harmlessly when the semaphore is already at its max count (already signaled).
+    if (e && e->sid >= 0) {
+        sceKernelSignalSema(e->sid, 1);
+    }
+}
+
+bool vd_event_wait(vd_event *e, int timeout_ms)
+{
+    if (!e || e->sid < 0) return false;
+    if (timeout_ms < 0) return sceKernelWaitSema(e->sid, 1, NULL) >= 0;
+
+    SceUInt timeout_us = (SceUInt)timeout_ms * 1000;
+    return sceKernelWaitSema(e->sid, 1, &timeout_us) >= 0;
+}
+
+void vd_event_destroy(vd_event *e)
+{
+    if (e) {
+        if (e->sid >= 0) {
+            sceKernelDeleteSema(e->sid);
+        }
+        free(e);
+    }
+}
+
 #endif /* __vita__ */
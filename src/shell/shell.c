@@ -42,7 +42,8 @@ static int shell_text_baseline_y(int row_top, int font_h)
 
 static void shell_draw_footer_hint(void)
 {
-    DrawText("Start / F1 · Confirm · Back", SHELL_PADDING, SHELL_FOOTER_Y, SHELL_FONT_CAPTION, GRAY);
+    DrawText("Start / F1 · Confirm · Back · Select / F3 Perf HUD", SHELL_PADDING, SHELL_FOOTER_Y, SHELL_FONT_CAPTION,
+             GRAY);
 }
 
 static bool start_pressed(void)
@@ -51,6 +52,12 @@ static bool start_pressed(void)
     return gamepad || IsKeyPressed(KEY_F1);
 }
 
+static bool select_pressed(void)
+{
+    bool gamepad = IsGamepadAvailable(0) && IsGamepadButtonPressed(0, GAMEPAD_BUTTON_MIDDLE_LEFT);
+    return gamepad || IsKeyPressed(KEY_F3);
+}
+
 static bool confirm_pressed(void)
 {
     bool gamepad = IsGamepadAvailable(0) && IsGamepadButtonPressed(0, GAMEPAD_BUTTON_RIGHT_FACE_DOWN);
@@ -243,6 +250,11 @@ bool shell_is_visible(const VdShell *shell)
     return shell->state != VD_SHELL_HIDDEN;
 }
 
+bool shell_perf_overlay_visible(const VdShell *shell)
+{
+    return shell->perf_overlay;
+}
+
 void shell_update(VdShell *shell, bool *request_runtime_restart)
 {
     char message[256];
@@ -259,6 +271,8 @@ void shell_update(VdShell *shell, bool *request_runtime_restart)
 
 void shell_poll_system_input(VdShell *shell, bool *request_runtime_restart)
 {
+    if (select_pressed()) shell->perf_overlay = !shell->perf_overlay;
+
     if (start_pressed()) {
         if (shell->state == VD_SHELL_HIDDEN) {
             shell->state = VD_SHELL_HOME;
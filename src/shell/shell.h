@@ -11,6 +11,7 @@ typedef enum { VD_SHELL_HIDDEN, VD_SHELL_HOME } VdShellState;
 
 typedef struct {
     VdShellState state;
+    bool perf_overlay;
     int focus_row;
     int scroll_row;
     int focus_col;
@@ -26,6 +27,7 @@ void shell_init(VdShell *shell);
 void shell_show_home(VdShell *shell);
 void shell_shutdown(VdShell *shell);
 bool shell_is_visible(const VdShell *shell);
+bool shell_perf_overlay_visible(const VdShell *shell);
 void shell_update(VdShell *shell, bool *request_runtime_restart);
 void shell_poll_system_input(VdShell *shell, bool *request_runtime_restart);
 void shell_render(VdShell *shell);
@@ -0,0 +1,231 @@
+#include "hit_grid.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "stb_ds.h"
+#include "scroll.h"
+
+#define HIT_GRID_CELL 32
+#define HIT_GRID_MAX_DIM 64
+
+typedef struct {
+    InstanceHandle id;
+    int x, y, width, height;
+    unsigned int flags;
+    int child_layer;
+} HitEntry;
+
+typedef struct {
+    InstanceHandle owner;
+    int content_x, content_y; // content origin in the parent layer
+    HitEntry *entries;
+    // Cell c holds cell_items[cell_start[c] .. cell_start[c + 1]), entry indices in paint order.
+    int *cell_start;
+    int *cell_items;
+    int origin_x, origin_y;
+    int cell_size;
+    int cols, rows;
+} HitLayer;
+
+struct HitIndex {
+    HitLayer *layers;
+};
+
+HitIndex *hit_index_create(void)
+{
+    HitIndex *index = calloc(1, sizeof(HitIndex));
+    if (!index) return NULL;
+    if (hit_index_add_layer(index, INSTANCE_HANDLE_NONE, 0, 0) == HIT_LAYER_NONE) {
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+void hit_index_free(HitIndex *index)
+{
+    if (!index) return;
+    int count = arrlen(index->layers);
+    for (int i = 0; i < count; i++) {
+        arrfree(index->layers[i].entries);
+        arrfree(index->layers[i].cell_start);
+        arrfree(index->layers[i].cell_items);
+    }
+    arrfree(index->layers);
+    free(index);
+}
+
+int hit_index_add_layer(HitIndex *index, InstanceHandle owner, int content_x, int content_y)
+{
+    if (!index) return HIT_LAYER_NONE;
+    HitLayer layer = {.owner = owner, .content_x = content_x, .content_y = content_y, .cell_size = HIT_GRID_CELL};
+    arrput(index->layers, layer);
+    return (int)arrlen(index->layers) - 1;
+}
+
+void hit_index_add(HitIndex *index, int layer, InstanceHandle id, int x, int y, int width, int height,
+                   unsigned int flags, int child_layer)
+{
+    if (!index || layer < 0 || layer >= arrlen(index->layers)) return;
+    if (id == INSTANCE_HANDLE_NONE || width <= 0 || height <= 0) return;
+    HitEntry entry = {
+        .id = id, .x = x, .y = y, .width = width, .height = height, .flags = flags, .child_layer = child_layer};
+    arrput(index->layers[layer].entries, entry);
+}
+
+static void entry_cells(const HitLayer *l, const HitEntry *e, int *c0, int *r0, int *c1, int *r1)
+{
+    *c0 = (e->x - l->origin_x) / l->cell_size;
+    *r0 = (e->y - l->origin_y) / l->cell_size;
+    *c1 = (e->x + e->width - 1 - l->origin_x) / l->cell_size;
+    *r1 = (e->y + e->height - 1 - l->origin_y) / l->cell_size;
+}
+
+static void build_layer(HitLayer *l)
+{
+    int count = arrlen(l->entries);
+    if (count == 0) return;
+
+    int min_x = l->entries[0].x, min_y = l->entries[0].y;
+    int max_x = l->entries[0].x + l->entries[0].width, max_y = l->entries[0].y + l->entries[0].height;
+    for (int i = 1; i < count; i++) {
+        const HitEntry *e = &l->entries[i];
+        if (e->x < min_x) min_x = e->x;
+        if (e->y < min_y) min_y = e->y;
+        if (e->x + e->width > max_x) max_x = e->x + e->width;
+        if (e->y + e->height > max_y) max_y = e->y + e->height;
+    }
+
+    l->origin_x = min_x;
+    l->origin_y = min_y;
+    l->cell_size = HIT_GRID_CELL;
+    while ((max_x - min_x + l->cell_size - 1) / l->cell_size > HIT_GRID_MAX_DIM ||
+           (max_y - min_y + l->cell_size - 1) / l->cell_size > HIT_GRID_MAX_DIM) {
+        l->cell_size *= 2;
+    }
+    int cols = (max_x - min_x + l->cell_size - 1) / l->cell_size;
+    int rows = (max_y - min_y + l->cell_size - 1) / l->cell_size;
+
+    // Counting sort of (cell, entry) pairs keeps each cell's entries in paint order.
+    arrsetlen(l->cell_start, cols * rows + 1);
+    memset(l->cell_start, 0, (size_t)(cols * rows + 1) * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        int c0, r0, c1, r1;
+        entry_cells(l, &l->entries[i], &c0, &r0, &c1, &r1);
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+                l->cell_start[r * cols + c + 1]++;
+    }
+    for (int c = 0; c < cols * rows; c++) {
+        l->cell_start[c + 1] += l->cell_start[c];
+    }
+
+    arrsetlen(l->cell_items, l->cell_start[cols * rows]);
+    int *fill = malloc((size_t)(cols * rows) * sizeof(int));
+    if (!fill) return;
+    memcpy(fill, l->cell_start, (size_t)(cols * rows) * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        int c0, r0, c1, r1;
+        entry_cells(l, &l->entries[i], &c0, &r0, &c1, &r1);
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+                l->cell_items[fill[r * cols + c]++] = i;
+    }
+    free(fill);
+    l->cols = cols;
+    l->rows = rows;
+}
+
+void hit_index_build(HitIndex *index)
+{
+    if (!index) return;
+    int count = arrlen(index->layers);
+    for (int i = 0; i < count; i++) {
+        build_layer(&index->layers[i]);
+    }
+}
+
+static InstanceHandle query_layer(const HitIndex *index, int layer, int x, int y, unsigned int flags)
+{
+    const HitLayer *l = &index->layers[layer];
+    if (l->cols == 0 || x < l->origin_x || y < l->origin_y) return INSTANCE_HANDLE_NONE;
+    int c = (x - l->origin_x) / l->cell_size;
+    int r = (y - l->origin_y) / l->cell_size;
+    if (c >= l->cols || r >= l->rows) return INSTANCE_HANDLE_NONE;
+
+    int cell = r * l->cols + c;
+    for (int i = l->cell_start[cell + 1] - 1; i >= l->cell_start[cell]; i--) {
+        const HitEntry *e = &l->entries[l->cell_items[i]];
+        if (x < e->x || x >= e->x + e->width || y < e->y || y >= e->y + e->height) continue;
+        // Content paints over its viewport, and only the part inside the viewport can be hit.
+        if (e->child_layer != HIT_LAYER_NONE) {
+            const HitLayer *content = &index->layers[e->child_layer];
+            InstanceHandle hit = query_layer(index, e->child_layer, x - content->content_x,
+                                             y - content->content_y + scroll_get_offset(content->owner), flags);
+            if (hit != INSTANCE_HANDLE_NONE) return hit;
+        }
+        if (e->flags & flags) return e->id;
+    }
+    return INSTANCE_HANDLE_NONE;
+}
+
+InstanceHandle hit_index_query(const HitIndex *index, int x, int y, unsigned int flags)
+{
+    if (!index) return INSTANCE_HANDLE_NONE;
+    return query_layer(index, 0, x, y, flags);
+}
+
+typedef struct {
+    bool has;
+    int x, y, width, height;
+} ClipRect;
+
+static bool clip_contains_any(const ClipRect *clip, int x, int y, int width, int height)
+{
+    if (!clip->has) return true;
+    return x < clip->x + clip->width && x + width > clip->x && y < clip->y + clip->height && y + height > clip->y;
+}
+
+static ClipRect clip_intersect(const ClipRect *clip, int x, int y, int width, int height)
+{
+    ClipRect out = {.has = true, .x = x, .y = y, .width = width, .height = height};
+    if (!clip->has) return out;
+    int x2 = x + width < clip->x + clip->width ? x + width : clip->x + clip->width;
+    int y2 = y + height < clip->y + clip->height ? y + height : clip->y + clip->height;
+    out.x = x > clip->x ? x : clip->x;
+    out.y = y > clip->y ? y : clip->y;
+    out.width = x2 - out.x;
+    out.height = y2 - out.y;
+    return out;
+}
+
+static void collect_layer(const HitIndex *index, int layer, int offset_x, int offset_y, const ClipRect *clip,
+                          unsigned int flags, HitRect **out)
+{
+    const HitLayer *l = &index->layers[layer];
+    int count = arrlen(l->entries);
+    for (int i = 0; i < count; i++) {
+        const HitEntry *e = &l->entries[i];
+        int x = offset_x + e->x;
+        int y = offset_y + e->y;
+        if (!clip_contains_any(clip, x, y, e->width, e->height)) continue;
+        if (e->flags & flags) {
+            HitRect rect = {.id = e->id, .x = x, .y = y, .width = e->width, .height = e->height};
+            arrput(*out, rect);
+        }
+        if (e->child_layer == HIT_LAYER_NONE) continue;
+
+        ClipRect viewport = clip_intersect(clip, x, y, e->width, e->height);
+        if (viewport.width <= 0 || viewport.height <= 0) continue;
+        const HitLayer *content = &index->layers[e->child_layer];
+        collect_layer(index, e->child_layer, offset_x + content->content_x,
+                      offset_y + content->content_y - scroll_get_offset(content->owner), &viewport, flags, out);
+    }
+}
+
+void hit_index_collect(const HitIndex *index, unsigned int flags, HitRect **out)
+{
+    if (!index) return;
+    ClipRect none = {0};
+    collect_layer(index, 0, 0, 0, &none, flags, out);
+}
@@ -0,0 +1,53 @@
+#ifndef HIT_GRID_H
+#define HIT_GRID_H
+
+#include "instance_tree.h"
+
+/* Hit index of one published snapshot: uniform grids over the rectangles of hittable instances.
+ * The content of each scroll container is indexed in a layer of its own, in unscrolled content
+ * coordinates, so a scroll needs no rebuild: queries map the point through the current offset when
+ * they descend into a scroll viewport. Entries are added in paint order and a query returns the
+ * topmost one containing the point.
+ *
+ * Built on the JS thread when a snapshot is published, then handed to the UI thread, which owns it
+ * and queries it without the render lock (queries read the UI-thread scroll offsets). */
+
+typedef enum {
+    HIT_POINTER = 1 << 0, /* target of pointer hit tests */
+    HIT_SCROLL = 1 << 1,  /* scroll container viewport */
+    HIT_FOCUS = 1 << 2,   /* gamepad focus target */
+} HitFlags;
+
+#define HIT_LAYER_NONE (-1)
+
+typedef struct HitIndex HitIndex;
+
+/* A new index holding only the (empty) root layer, layer 0. */
+HitIndex *hit_index_create(void);
+void hit_index_free(HitIndex *index);
+
+/* Add a layer for the content of scroll container owner, whose content origin sits at
+ * (content_x, content_y) in the parent layer. Returns the layer, or HIT_LAYER_NONE. */
+int hit_index_add_layer(HitIndex *index, InstanceHandle owner, int content_x, int content_y);
+
+/* Add a rectangle to layer in paint order. A scroll viewport passes the layer of its content as
+ * child_layer, other entries HIT_LAYER_NONE. */
+void hit_index_add(HitIndex *index, int layer, InstanceHandle id, int x, int y, int width, int height,
+                   unsigned int flags, int child_layer);
+
+/* Bucket every layer's entries; call once after the last add, before querying. */
+void hit_index_build(HitIndex *index);
+
+/* Topmost entry with any of flags set containing screen point (x, y), or INSTANCE_HANDLE_NONE. */
+InstanceHandle hit_index_query(const HitIndex *index, int x, int y, unsigned int flags);
+
+typedef struct {
+    InstanceHandle id;
+    int x, y, width, height;
+} HitRect;
+
+/* Append the entries with any of flags set that are at least partly inside their scroll viewports,
+ * in paint order, as unclipped screen rectangles under the current scroll offsets. */
+void hit_index_collect(const HitIndex *index, unsigned int flags, HitRect **out);
+
+#endif /* HIT_GRID_H */
@@ -2,6 +2,7 @@
 #include <string.h>
 #include <math.h>
 #include <raylib.h>
+#include "stb_ds.h"
 #include "instance_tree.h"
 #include "scroll.h"
 #include "core/event_queue.h"
@@ -15,42 +16,66 @@
 static bool prev_is_mouse_down = false;
 static int prev_mouse_x = -1;
 static int prev_mouse_y = -1;
-static char *hovered_id = NULL;
-static char *mouse_down_id = NULL;
+static InstanceHandle hovered_id = INSTANCE_HANDLE_NONE;
+static InstanceHandle mouse_down_id = INSTANCE_HANDLE_NONE;
 
 // Touch state
 static bool prev_touch_down = false;
-static char *touch_hovered_id = NULL;
-static char *touch_down_id = NULL;
+static InstanceHandle touch_hovered_id = INSTANCE_HANDLE_NONE;
+static InstanceHandle touch_down_id = INSTANCE_HANDLE_NONE;
 
 // Gamepad focus state
-static char *focused_id = NULL;
-static char *gamepad_down_id = NULL;
+static InstanceHandle focused_id = INSTANCE_HANDLE_NONE;
+static InstanceHandle gamepad_down_id = INSTANCE_HANDLE_NONE;
 static bool prev_confirm_down = false;
 
-// Push an input event to the queue (called from UI thread)
-static void push_input_event(const char *id, const char *event)
+// Events raised during the current poll; coalesced here and queued by input_flush_events().
+static InputEvent *pending_events = NULL;
+
+// Record an input event (called from UI thread)
+static void push_input_event(InstanceHandle id, InputEventKind kind)
+{
+    // Entering and leaving the same instance within one frame (in either order) cancels out.
+    if (kind == INPUT_MOUSEENTER || kind == INPUT_MOUSELEAVE) {
+        InputEventKind opposite = kind == INPUT_MOUSEENTER ? INPUT_MOUSELEAVE : INPUT_MOUSEENTER;
+        for (int i = (int)arrlen(pending_events) - 1; i >= 0; i--) {
+            if (pending_events[i].target != id) continue;
+            if (pending_events[i].kind == opposite) {
+                arrdel(pending_events, i);
+                return;
+            }
+            break;
+        }
+    }
+
+    InputEvent evt = {.type = EVT_INPUT, .kind = kind, .target = id, .time = GetTime()};
+    arrput(pending_events, evt);
+}
+
+void input_flush_events(void)
 {
-    InputEvent evt;
-    evt.type = EVT_INPUT;
-    strncpy(evt.id, id, sizeof(evt.id) - 1);
-    evt.id[sizeof(evt.id) - 1] = '\0';
-    strncpy(evt.event_name, event, sizeof(evt.event_name) - 1);
-    evt.event_name[sizeof(evt.event_name) - 1] = '\0';
-    event_queue_push(&evt);
+    event_queue_push_many(pending_events, (int)arrlen(pending_events));
+    arrsetlen(pending_events, 0);
+}
+
+void input_reset(void)
+{
+    hovered_id = INSTANCE_HANDLE_NONE;
+    mouse_down_id = INSTANCE_HANDLE_NONE;
+    touch_hovered_id = INSTANCE_HANDLE_NONE;
+    touch_down_id = INSTANCE_HANDLE_NONE;
+    focused_id = INSTANCE_HANDLE_NONE;
+    gamepad_down_id = INSTANCE_HANDLE_NONE;
+    arrsetlen(pending_events, 0);
 }
 
 void input_clear_focus(void)
 {
     if (focused_id) {
-        push_input_event(focused_id, "mouseleave");
-        free(focused_id);
-        focused_id = NULL;
-    }
-    if (gamepad_down_id) {
-        free(gamepad_down_id);
-        gamepad_down_id = NULL;
+        push_input_event(focused_id, INPUT_MOUSELEAVE);
+        focused_id = INSTANCE_HANDLE_NONE;
     }
+    gamepad_down_id = INSTANCE_HANDLE_NONE;
 }
 
 void poll_mouse_input(void)
@@ -63,33 +88,25 @@ void poll_mouse_input(void)
     prev_mouse_x = x;
     prev_mouse_y = y;
 
-    const char *top_id = instance_hit_test(x, y);
+    InstanceHandle top_id = instance_hit_test(x, y);
 
     if (hovered_id && !instance_exists(hovered_id)) {
-        free(hovered_id);
-        hovered_id = NULL;
+        hovered_id = INSTANCE_HANDLE_NONE;
     }
 
     // Mouse enter/leave (only process if mouse actually moved)
     if (mouse_moved) {
-        bool hover_changed = false;
-        if ((hovered_id == NULL && top_id != NULL) ||
-            (hovered_id != NULL && (top_id == NULL || strcmp(hovered_id, top_id) != 0))) {
-            hover_changed = true;
-        }
-
-        if (hover_changed) {
+        if (hovered_id != top_id) {
             input_clear_focus();
             if (hovered_id) {
-                TraceLog(LOG_DEBUG, "mouseleave: %s", hovered_id);
-                push_input_event(hovered_id, "mouseleave");
-                free(hovered_id);
-                hovered_id = NULL;
+                TraceLog(LOG_DEBUG, "mouseleave: %u", hovered_id);
+                push_input_event(hovered_id, INPUT_MOUSELEAVE);
+                hovered_id = INSTANCE_HANDLE_NONE;
             }
             if (top_id) {
-                hovered_id = strdup(top_id);
-                TraceLog(LOG_DEBUG, "mouseenter: %s", hovered_id);
-                push_input_event(hovered_id, "mouseenter");
+                hovered_id = top_id;
+                TraceLog(LOG_DEBUG, "mouseenter: %u", hovered_id);
+                push_input_event(hovered_id, INPUT_MOUSEENTER);
             }
         }
     }
@@ -102,36 +119,31 @@ void poll_mouse_input(void)
     if (just_pressed) {
         input_clear_focus();
         if (top_id) {
-            if (mouse_down_id) {
-                free(mouse_down_id);
-                mouse_down_id = NULL;
-            }
-            mouse_down_id = strdup(top_id);
-            TraceLog(LOG_DEBUG, "mousedown: %s", mouse_down_id);
-            push_input_event(mouse_down_id, "mousedown");
+            mouse_down_id = top_id;
+            TraceLog(LOG_DEBUG, "mousedown: %u", mouse_down_id);
+            push_input_event(mouse_down_id, INPUT_MOUSEDOWN);
         }
     }
 
     // Mouse up and click
     if (just_released) {
         if (mouse_down_id) {
-            TraceLog(LOG_DEBUG, "mouseup: %s", mouse_down_id);
-            push_input_event(mouse_down_id, "mouseup");
+            TraceLog(LOG_DEBUG, "mouseup: %u", mouse_down_id);
+            push_input_event(mouse_down_id, INPUT_MOUSEUP);
 
-            if (hovered_id && strcmp(mouse_down_id, hovered_id) == 0) {
-                TraceLog(LOG_DEBUG, "click: %s", mouse_down_id);
-                push_input_event(mouse_down_id, "click");
+            if (mouse_down_id == hovered_id) {
+                TraceLog(LOG_DEBUG, "click: %u", mouse_down_id);
+                push_input_event(mouse_down_id, INPUT_CLICK);
             }
 
-            free(mouse_down_id);
-            mouse_down_id = NULL;
+            mouse_down_id = INSTANCE_HANDLE_NONE;
         }
     }
 
     // Mouse wheel scrolls the scroll container under the cursor
     const float wheel = GetMouseWheelMove();
     if (wheel != 0.0f) {
-        char *scroll_id = instance_scroll_at(x, y);
+        InstanceHandle scroll_id = instance_scroll_at(x, y);
         if (scroll_id) {
             int viewport_h = 0, content_h = 0;
             if (instance_scroll_metrics(scroll_id, &viewport_h, &content_h)) {
@@ -142,7 +154,6 @@ void poll_mouse_input(void)
                 if (next > max_scroll) next = max_scroll;
                 scroll_set_offset(scroll_id, next);
             }
-            free(scroll_id);
         }
     }
 
@@ -162,30 +173,22 @@ void poll_touch_input(void)
         y = (int)pos.y;
     }
 
-    const char *top_id = is_down ? instance_hit_test(x, y) : NULL;
+    InstanceHandle top_id = is_down ? instance_hit_test(x, y) : INSTANCE_HANDLE_NONE;
 
     if (touch_hovered_id && !instance_exists(touch_hovered_id)) {
-        free(touch_hovered_id);
-        touch_hovered_id = NULL;
+        touch_hovered_id = INSTANCE_HANDLE_NONE;
     }
 
     // Hover enter/leave while finger is down
     if (is_down) {
-        bool hover_changed = false;
-        if ((touch_hovered_id == NULL && top_id != NULL) ||
-            (touch_hovered_id != NULL && (top_id == NULL || strcmp(touch_hovered_id, top_id) != 0))) {
-            hover_changed = true;
-        }
-
-        if (hover_changed) {
+        if (touch_hovered_id != top_id) {
             if (touch_hovered_id) {
-                push_input_event(touch_hovered_id, "mouseleave");
-                free(touch_hovered_id);
-                touch_hovered_id = NULL;
+                push_input_event(touch_hovered_id, INPUT_MOUSELEAVE);
+                touch_hovered_id = INSTANCE_HANDLE_NONE;
             }
             if (top_id) {
-                touch_hovered_id = strdup(top_id);
-                push_input_event(touch_hovered_id, "mouseenter");
+                touch_hovered_id = top_id;
+                push_input_event(touch_hovered_id, INPUT_MOUSEENTER);
             }
         }
     }
@@ -197,153 +200,53 @@ void poll_touch_input(void)
     if (just_pressed) {
         input_clear_focus();
         if (top_id) {
-            if (touch_down_id) {
-                free(touch_down_id);
-                touch_down_id = NULL;
-            }
-            touch_down_id = strdup(top_id);
-            push_input_event(touch_down_id, "mousedown");
+            touch_down_id = top_id;
+            push_input_event(touch_down_id, INPUT_MOUSEDOWN);
         }
     }
 
     // Touch up -> mouseup (+ click if released over same target)
     if (just_released) {
         if (touch_down_id) {
-            push_input_event(touch_down_id, "mouseup");
+            push_input_event(touch_down_id, INPUT_MOUSEUP);
 
-            if (touch_hovered_id && strcmp(touch_down_id, touch_hovered_id) == 0) {
-                push_input_event(touch_down_id, "click");
+            if (touch_down_id == touch_hovered_id) {
+                push_input_event(touch_down_id, INPUT_CLICK);
             }
         }
 
         if (touch_hovered_id) {
-            push_input_event(touch_hovered_id, "mouseleave");
+            push_input_event(touch_hovered_id, INPUT_MOUSELEAVE);
         }
 
-        if (touch_down_id) {
-            free(touch_down_id);
-            touch_down_id = NULL;
-        }
-        if (touch_hovered_id) {
-            free(touch_hovered_id);
-            touch_hovered_id = NULL;
-        }
+        touch_down_id = INSTANCE_HANDLE_NONE;
+        touch_hovered_id = INSTANCE_HANDLE_NONE;
     }
 
     prev_touch_down = is_down;
 }
 
-typedef enum { NAV_UP, NAV_DOWN, NAV_LEFT, NAV_RIGHT } NavDirection;
-
-static void set_focus(const char *new_id)
+static void set_focus(InstanceHandle new_id)
 {
     if (focused_id) {
-        if (new_id && strcmp(focused_id, new_id) == 0) return;
-        push_input_event(focused_id, "mouseleave");
-        free(focused_id);
-        focused_id = NULL;
+        if (focused_id == new_id) return;
+        push_input_event(focused_id, INPUT_MOUSELEAVE);
+        focused_id = INSTANCE_HANDLE_NONE;
     }
     if (new_id) {
-        focused_id = strdup(new_id);
-        push_input_event(focused_id, "mouseenter");
+        focused_id = new_id;
+        push_input_event(focused_id, INPUT_MOUSEENTER);
     }
 }
 
-static const char *find_nearest_focusable(NavDirection dir)
-{
-    int elem_count = 0;
-    FocusableElement *elems = get_focusable_elements(&elem_count);
-    if (!elems || elem_count == 0) return NULL;
-
-    int cur_cx = 0, cur_cy = 0;
-    bool has_current = false;
-
-    // Find current focused element center
-    if (focused_id) {
-        for (int i = 0; i < elem_count; i++) {
-            if (strcmp(elems[i].id, focused_id) == 0) {
-                cur_cx = elems[i].x + elems[i].width / 2;
-                cur_cy = elems[i].y + elems[i].height / 2;
-                has_current = true;
-                break;
-            }
-        }
-    }
-
-    // If no current focus, pick first element
-    if (!has_current) {
-        const char *first_id = elems[0].id;
-        char *result = strdup(first_id);
-        free_focusable_elements(elems, elem_count);
-        return result;
-    }
-
-    const char *best_id = NULL;
-    float best_score = 1e9f;
-
-    for (int i = 0; i < elem_count; i++) {
-        if (focused_id && strcmp(elems[i].id, focused_id) == 0) continue;
-
-        int cx = elems[i].x + elems[i].width / 2;
-        int cy = elems[i].y + elems[i].height / 2;
-        int dx = cx - cur_cx;
-        int dy = cy - cur_cy;
-
-        // Check if element is in the correct direction
-        bool valid = false;
-        switch (dir) {
-        case NAV_UP:
-            valid = dy < 0;
-            break;
-        case NAV_DOWN:
-            valid = dy > 0;
-            break;
-        case NAV_LEFT:
-            valid = dx < 0;
-            break;
-        case NAV_RIGHT:
-            valid = dx > 0;
-            break;
-        }
-        if (!valid) continue;
-
-        // Calculate weighted distance (favor elements more aligned with direction)
-        float primary = 0, secondary = 0;
-        switch (dir) {
-        case NAV_UP:
-        case NAV_DOWN:
-            primary = fabsf((float)dy);
-            secondary = fabsf((float)dx);
-            break;
-        case NAV_LEFT:
-        case NAV_RIGHT:
-            primary = fabsf((float)dx);
-            secondary = fabsf((float)dy);
-            break;
-        }
-        float score = primary + secondary * 2.0f;
-
-        if (score < best_score) {
-            best_score = score;
-            best_id = elems[i].id;
-        }
-    }
-
-    char *result = best_id ? strdup(best_id) : NULL;
-    free_focusable_elements(elems, elem_count);
-    return result;
-}
-
 void poll_gamepad_input(void)
 {
     // Check if focused element still exists
     if (focused_id && !instance_exists(focused_id)) {
-        free(focused_id);
-        focused_id = NULL;
+        focused_id = INSTANCE_HANDLE_NONE;
     }
     if (gamepad_down_id && !instance_exists(gamepad_down_id)) {
-        free(gamepad_down_id);
-        gamepad_down_id = NULL;
+        gamepad_down_id = INSTANCE_HANDLE_NONE;
     }
 
     // Read d-pad input (gamepad or keyboard)
@@ -368,7 +271,7 @@ void poll_gamepad_input(void)
     confirm_down = confirm_down || IsKeyDown(KEY_ENTER);
 
     int viewport_h = 0, content_h = 0;
-    char *scroll_id = focused_id ? instance_scroll_for_descendant(focused_id) : NULL;
+    InstanceHandle scroll_id = instance_scroll_for_descendant(focused_id);
     if (scroll_id && instance_scroll_metrics(scroll_id, &viewport_h, &content_h)) {
         int max_scroll = content_h - viewport_h;
         if (max_scroll < 0) max_scroll = 0;
@@ -385,16 +288,12 @@ void poll_gamepad_input(void)
             scroll_set_offset(scroll_id, next);
         }
     }
-    if (scroll_id) free(scroll_id);
 
     // Navigation
     if (up || down || left || right) {
-        NavDirection dir = up ? NAV_UP : down ? NAV_DOWN : left ? NAV_LEFT : NAV_RIGHT;
-        const char *next_id = find_nearest_focusable(dir);
-        if (next_id) {
-            set_focus(next_id);
-            free((void *)next_id);
-        }
+        FocusDirection dir = up ? FOCUS_UP : down ? FOCUS_DOWN : left ? FOCUS_LEFT : FOCUS_RIGHT;
+        InstanceHandle next_id = instance_focus_next(focused_id, dir);
+        if (next_id) set_focus(next_id);
     }
 
     // Activation (Cross/Enter)
@@ -402,40 +301,29 @@ void poll_gamepad_input(void)
     bool just_released = !confirm_down && prev_confirm_down;
 
     if (just_pressed && focused_id) {
-        if (gamepad_down_id) {
-            free(gamepad_down_id);
-            gamepad_down_id = NULL;
-        }
-        gamepad_down_id = strdup(focused_id);
-        push_input_event(gamepad_down_id, "mousedown");
+        gamepad_down_id = focused_id;
+        push_input_event(gamepad_down_id, INPUT_MOUSEDOWN);
     }
 
     if (just_released && gamepad_down_id) {
-        push_input_event(gamepad_down_id, "mouseup");
-        if (focused_id && strcmp(gamepad_down_id, focused_id) == 0) {
-            push_input_event(gamepad_down_id, "click");
+        push_input_event(gamepad_down_id, INPUT_MOUSEUP);
+        if (gamepad_down_id == focused_id) {
+            push_input_event(gamepad_down_id, INPUT_CLICK);
         }
-        free(gamepad_down_id);
-        gamepad_down_id = NULL;
+        gamepad_down_id = INSTANCE_HANDLE_NONE;
     }
 
     prev_confirm_down = confirm_down;
 }
 
-bool input_is_hovered(const char *id)
+bool input_is_hovered(InstanceHandle id)
 {
-    if (!id) return false;
-    if (hovered_id && strcmp(hovered_id, id) == 0) return true;
-    if (touch_hovered_id && strcmp(touch_hovered_id, id) == 0) return true;
-    if (focused_id && strcmp(focused_id, id) == 0) return true;
-    return false;
+    if (id == INSTANCE_HANDLE_NONE) return false;
+    return hovered_id == id || touch_hovered_id == id || focused_id == id;
 }
 
-bool input_is_pressed(const char *id)
+bool input_is_pressed(InstanceHandle id)
 {
-    if (!id) return false;
-    if (mouse_down_id && strcmp(mouse_down_id, id) == 0) return true;
-    if (touch_down_id && strcmp(touch_down_id, id) == 0) return true;
-    if (gamepad_down_id && strcmp(gamepad_down_id, id) == 0) return true;
-    return false;
+    if (id == INSTANCE_HANDLE_NONE) return false;
+    return mouse_down_id == id || touch_down_id == id || gamepad_down_id == id;
 }
@@ -2,14 +2,21 @@
 #define INPUT_H
 
 #include <stdbool.h>
+#include "instance_tree.h"
 
 void poll_mouse_input(void);
 void poll_touch_input(void);
 void poll_gamepad_input(void);
+// Queue the events raised by the poll_* calls of this frame for the JS thread.
+void input_flush_events(void);
 
+// Drop gamepad focus, raising mouseleave on the focused instance. Queued by the next flush.
 void input_clear_focus(void);
+// Forget every hovered, pressed and focused instance and drop unflushed events without raising
+// any. Handles restart in each runtime, so state from the previous one must not reach the next.
+void input_reset(void);
 
-bool input_is_hovered(const char *id);
-bool input_is_pressed(const char *id);
+bool input_is_hovered(InstanceHandle id);
+bool input_is_pressed(InstanceHandle id);
 
 #endif /* INPUT_H */
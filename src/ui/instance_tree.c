@@ -1,92 +1,160 @@
+#include <math.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <raylib.h>
-#include "arena.h"
 #include "stb_ds.h"
 #include "instance_tree.h"
+#include "hit_grid.h"
 #include "scroll.h"
+#include "text_layout.h"
+#include "core/latency.h"
+#include "core/profiler.h"
 #include "platform/thread.h"
 
+// Front registry slot. Holds the latest published copy of the instance and its parent
+// handle (copies are shared between parents, so they carry no link).
 typedef struct {
-    char *key;
     ReactInstance *value;
-} InstanceEntry;
+    InstanceHandle parent;
+} FrontSlot;
 
-// Snapshot structure for thread-safe access
+// Snapshot structure for thread-safe access. Instances are reference counted and
+// shared with the previous snapshot when their back-buffer subtree did not change.
 typedef struct {
-    Arena arena;
-    InstanceEntry *registry;
     ReactInstance **root_children;
 } InstanceSnapshot;
 
-// Back buffer: JS thread writes here (single-threaded access)
-static InstanceEntry *back_registry = NULL;
+typedef struct {
+    InstanceHandle id;
+    ReactInstance *copy;
+    InstanceHandle parent;
+} PendingFrontPut;
+
+// Back buffer: JS thread writes here (single-threaded access). Registries are slot
+// arrays indexed by instance_handle_index().
+static ReactInstance **back_slots = NULL;
 static ReactInstance **back_root_children = NULL;
 
+// Bumped on every back-buffer mutation; swap is skipped while it matches the published one.
+static unsigned int back_generation = 1;
+static unsigned int published_generation = 0;
+
+// Generation of the back buffer at the last React commit boundary. Only committed
+// states are published, so the UI never observes a half-applied commit.
+static unsigned int committed_generation = 0;
+
+// Front registry changes collected on the JS thread and applied under the lock on swap,
+// so publishing costs O(changed instances) instead of rebuilding the whole map.
+static PendingFrontPut *pending_front_puts = NULL;
+static InstanceHandle *pending_front_dels = NULL;
+static ReactInstance **pending_instance_releases = NULL;
+
 // Front snapshot: UI thread reads from here
 static InstanceSnapshot *front_snapshot = NULL;
+static FrontSlot *front_slots = NULL;
+
+// Bumped under the lock whenever front_snapshot is replaced.
+static unsigned int front_generation = 0;
+
+// Hit index of the latest publish, built with its snapshot and waiting for the UI thread to take
+// it (see ensure_front_index). Guarded by snapshot_mutex.
+static HitIndex *pending_hit_index = NULL;
+static bool hit_index_pending = false;
 
 // Mutex to protect front_snapshot access during swap
 static vd_mutex *snapshot_mutex = NULL;
 
-// Free an instance (shallow, does not free children)
-void instance_back_free(ReactInstance *inst)
+// Benchmark counters (JS thread), see instance_tree_get_stats().
+static InstanceTreeStats stats;
+
+typedef struct {
+    int refcount;
+    char chars[];
+} InstanceString;
+
+static InstanceString *instance_string_header(char *str)
 {
-    if (!inst) return;
-    if (inst->id) free(inst->id);
-    if (inst->type == NT_TEXT && inst->props.text.font_name) {
-        free(inst->props.text.font_name);
-    }
-    if (inst->type == NT_BUTTON && inst->props.button.label) {
-        free(inst->props.button.label);
-    }
-    if (inst->type == NT_RAW_TEXT && inst->props.raw_text) {
-        free(inst->props.raw_text);
-    }
-    if (inst->type == NT_IMAGE && inst->props.image.image_name) {
-        free(inst->props.image.image_name);
-    }
-    arrfree(inst->children);
-    free(inst);
+    return (InstanceString *)(str - offsetof(InstanceString, chars));
 }
 
-// Free an instance tree recursively
-static void free_instance_tree(ReactInstance *inst)
+char *instance_string_new(const char *str)
 {
-    if (!inst) return;
+    if (!str) str = "";
+    size_t len = strlen(str);
+    InstanceString *header = malloc(sizeof(InstanceString) + len + 1);
+    if (!header) return NULL;
+    header->refcount = 1;
+    memcpy(header->chars, str, len + 1);
+    return header->chars;
+}
+
+char *instance_string_retain(char *str)
+{
+    if (str) instance_string_header(str)->refcount++;
+    return str;
+}
 
+void instance_string_release(char *str)
+{
+    if (!str) return;
+    InstanceString *header = instance_string_header(str);
+    if (--header->refcount == 0) free(header);
+}
+
+static void free_instance_props(ReactInstance *inst)
+{
+    if (inst->type == NT_TEXT) instance_string_release(inst->props.text.font_name);
+    if (inst->type == NT_BUTTON) instance_string_release(inst->props.button.label);
+    if (inst->type == NT_RAW_TEXT) instance_string_release(inst->props.raw_text);
+    if (inst->type == NT_IMAGE) instance_string_release(inst->props.image.image_name);
+}
+
+static ReactInstance *retain_snapshot_instance(ReactInstance *inst)
+{
+    if (inst) inst->refcount++;
+    return inst;
+}
+
+// Heap owned by one snapshot copy, excluding the shared strings and text layout.
+static size_t snapshot_instance_bytes(const ReactInstance *inst)
+{
+    return sizeof(ReactInstance) + arrcap(inst->children) * sizeof(ReactInstance *);
+}
+
+// Text layouts are shared between copies, so they are counted once, while alive.
+static void release_text_layout(TextLayout *layout)
+{
+    size_t bytes = text_layout_bytes(layout);
+    if (text_layout_release(layout)) stats.snapshot_bytes -= bytes;
+}
+
+// Drop one reference to a snapshot copy; frees it (and releases its children) at zero.
+// Only the JS thread touches refcounts, or the UI thread once the JS thread is stopped.
+static void release_snapshot_instance(ReactInstance *inst)
+{
+    if (!inst || --inst->refcount > 0) return;
+
+    stats.snapshot_nodes--;
+    stats.snapshot_bytes -= snapshot_instance_bytes(inst);
     int count = arrlen(inst->children);
     for (int i = 0; i < count; i++) {
-        free_instance_tree(inst->children[i]);
-    }
-
-    if (inst->id) free(inst->id);
-    if (inst->type == NT_TEXT && inst->props.text.font_name) {
-        free(inst->props.text.font_name);
-    }
-    if (inst->type == NT_BUTTON && inst->props.button.label) {
-        free(inst->props.button.label);
-    }
-    if (inst->type == NT_RAW_TEXT && inst->props.raw_text) {
-        free(inst->props.raw_text);
-    }
-    if (inst->type == NT_IMAGE && inst->props.image.image_name) {
-        free(inst->props.image.image_name);
+        release_snapshot_instance(inst->children[i]);
     }
+    free_instance_props(inst);
+    release_text_layout(inst->text_layout);
     arrfree(inst->children);
     free(inst);
 }
 
-// Free stb_ds child arrays in a front-snapshot tree (instance data lives in the arena).
-static void free_snapshot_children_arrays(ReactInstance *inst)
+// Free an instance (shallow, does not free children)
+void instance_back_free(ReactInstance *inst)
 {
     if (!inst) return;
-
-    int count = arrlen(inst->children);
-    for (int i = 0; i < count; i++) {
-        free_snapshot_children_arrays(inst->children[i]);
-    }
+    free_instance_props(inst);
+    release_snapshot_instance(inst->snapshot);
     arrfree(inst->children);
+    free(inst);
 }
 
 // Free a snapshot
@@ -96,49 +164,38 @@ static void free_snapshot(InstanceSnapshot *snap)
 
     int count = arrlen(snap->root_children);
     for (int i = 0; i < count; i++) {
-        free_snapshot_children_arrays(snap->root_children[i]);
+        release_snapshot_instance(snap->root_children[i]);
     }
     arrfree(snap->root_children);
-    shfree(snap->registry);
-    arena_free(&snap->arena);
     free(snap);
 }
 
-// Deep copy a single instance (without children links)
-static ReactInstance *copy_instance(Arena *arena, ReactInstance *src)
+// Copy a single instance (without children links). Strings are immutable and shared
+// with the back instance, so a copy only allocates the instance itself.
+static ReactInstance *copy_instance(ReactInstance *src)
 {
     if (!src) return NULL;
 
-    ReactInstance *dst = arena_alloc(arena, sizeof(ReactInstance));
+    ReactInstance *dst = calloc(1, sizeof(ReactInstance));
     if (!dst) return NULL;
-    memset(dst, 0, sizeof(ReactInstance));
-    dst->id = src->id ? arena_strdup(arena, src->id) : NULL;
+    dst->id = src->id;
     dst->type = src->type;
-    dst->children = NULL;
-    dst->parent = NULL;
+    dst->props = src->props;
 
     switch (src->type) {
-    case NT_RECT:
-        dst->props.rect = src->props.rect;
-        break;
     case NT_TEXT:
-        dst->props.text = src->props.text;
-        dst->props.text.font_name = src->props.text.font_name ? arena_strdup(arena, src->props.text.font_name) : NULL;
+        instance_string_retain(dst->props.text.font_name);
         break;
     case NT_BUTTON:
-        dst->props.button = src->props.button;
-        dst->props.button.label = src->props.button.label ? arena_strdup(arena, src->props.button.label) : NULL;
+        instance_string_retain(dst->props.button.label);
         break;
     case NT_RAW_TEXT:
-        dst->props.raw_text = src->props.raw_text ? arena_strdup(arena, src->props.raw_text) : NULL;
-        break;
-    case NT_SCROLL:
-        dst->props.scroll = src->props.scroll;
+        instance_string_retain(dst->props.raw_text);
         break;
     case NT_IMAGE:
-        dst->props.image = src->props.image;
-        dst->props.image.image_name =
-            src->props.image.image_name ? arena_strdup(arena, src->props.image.image_name) : NULL;
+        instance_string_retain(dst->props.image.image_name);
+        break;
+    default:
         break;
     }
 
@@ -190,29 +247,83 @@ int scroll_content_height(const ReactInstance *scroll)
     return inner + s->padding * 2;
 }
 
-// Recursively copy instance and all children
-static ReactInstance *deep_copy_instance(Arena *arena, ReactInstance *src, InstanceEntry **new_registry)
+// Snapshot an instance subtree. Clean instances return their cached copy from the
+// previous swap; dirty ones are re-copied (queueing a front registry update), still
+// sharing any clean children. Returns a new reference owned by the caller.
+static ReactInstance *snapshot_instance(ReactInstance *src, InstanceHandle parent)
 {
     if (!src) return NULL;
+    if (!src->dirty && src->snapshot) return retain_snapshot_instance(src->snapshot);
 
-    ReactInstance *dst = copy_instance(arena, src);
+    ReactInstance *dst = copy_instance(src);
     if (!dst) return NULL;
-    if (dst->id) {
-        shput(*new_registry, dst->id, dst);
-    }
 
     int child_count = arrlen(src->children);
+    if (child_count > 0) arrsetcap(dst->children, child_count);
     for (int i = 0; i < child_count; i++) {
-        if (src->children[i]) {
-            ReactInstance *child_copy = deep_copy_instance(arena, src->children[i], new_registry);
-            if (child_copy) {
-                child_copy->parent = dst;
-                arrput(dst->children, child_copy);
-            }
+        ReactInstance *child_copy = snapshot_instance(src->children[i], src->id);
+        if (child_copy) arrput(dst->children, child_copy);
+    }
+    if (dst->type == NT_TEXT) {
+        // Moves, recolours and sibling changes keep the lines: only re-measure when they can differ.
+        TextLayout *prev = src->snapshot ? src->snapshot->text_layout : NULL;
+        if (text_layout_matches(prev, dst)) {
+            dst->text_layout = text_layout_retain(prev);
+        } else {
+            dst->text_layout = text_layout_create(dst);
+            stats.snapshot_bytes += text_layout_bytes(dst->text_layout);
         }
     }
+    stats.snapshot_copies++;
+    stats.snapshot_nodes++;
+    stats.snapshot_bytes += snapshot_instance_bytes(dst);
 
-    return dst;
+    PendingFrontPut put = {.id = src->id, .copy = retain_snapshot_instance(dst), .parent = parent};
+    arrput(pending_front_puts, put);
+
+    release_snapshot_instance(src->snapshot);
+    src->snapshot = retain_snapshot_instance(dst);
+    src->dirty = false;
+    return retain_snapshot_instance(dst);
+}
+
+// Must be called under the snapshot lock. Replaced references are queued and dropped
+// after the lock is released.
+static void apply_pending_front_registry(void)
+{
+    int put_count = arrlen(pending_front_puts);
+    for (int i = 0; i < put_count; i++) {
+        PendingFrontPut *put = &pending_front_puts[i];
+        uint32_t index = instance_handle_index(put->id);
+        uint32_t old_len = arrlenu(front_slots);
+        if (index >= old_len) {
+            arrsetlen(front_slots, index + 1);
+            memset(&front_slots[old_len], 0, (index + 1 - old_len) * sizeof(FrontSlot));
+        }
+        if (front_slots[index].value) arrput(pending_instance_releases, front_slots[index].value);
+        front_slots[index] = (FrontSlot){.value = put->copy, .parent = put->parent};
+    }
+    arrsetlen(pending_front_puts, 0);
+
+    int del_count = arrlen(pending_front_dels);
+    for (int i = 0; i < del_count; i++) {
+        InstanceHandle id = pending_front_dels[i];
+        uint32_t index = instance_handle_index(id);
+        if (index < arrlenu(front_slots) && front_slots[index].value && front_slots[index].value->id == id) {
+            arrput(pending_instance_releases, front_slots[index].value);
+            front_slots[index] = (FrontSlot){0};
+        }
+    }
+    arrsetlen(pending_front_dels, 0);
+}
+
+static void drain_pending_releases(void)
+{
+    int instance_count = arrlen(pending_instance_releases);
+    for (int i = 0; i < instance_count; i++) {
+        release_snapshot_instance(pending_instance_releases[i]);
+    }
+    arrsetlen(pending_instance_releases, 0);
 }
 
 void instance_tree_init(void)
@@ -222,49 +333,111 @@ void instance_tree_init(void)
     }
 }
 
+void instance_tree_commit(void)
+{
+    stats.commits++;
+    committed_generation = back_generation;
+    latency_committed();
+}
+
+static HitIndex *build_hit_index(ReactInstance **root_children);
+static HitIndex *publish_hit_index_locked(HitIndex *index);
+
 void instance_tree_swap(void)
 {
+    if (committed_generation == published_generation) return;
+
     // Create new snapshot from back buffer (outside lock)
+    double swap_start = GetTime();
+    double zone = prof_begin();
     InstanceSnapshot *new_snap = calloc(1, sizeof(InstanceSnapshot));
-    new_snap->registry = NULL;
     new_snap->root_children = NULL;
 
     int count = arrlen(back_root_children);
+    if (count > 0) arrsetcap(new_snap->root_children, count);
     for (int i = 0; i < count; i++) {
-        if (back_root_children[i]) {
-            ReactInstance *copy = deep_copy_instance(&new_snap->arena, back_root_children[i], &new_snap->registry);
-            arrput(new_snap->root_children, copy);
-        }
+        ReactInstance *copy = snapshot_instance(back_root_children[i], INSTANCE_HANDLE_NONE);
+        if (copy) arrput(new_snap->root_children, copy);
     }
+    prof_end(PROF_THREAD_JS, "snapshot", zone);
+
+    zone = prof_begin();
+    HitIndex *hit_index = build_hit_index(new_snap->root_children);
+    prof_end(PROF_THREAD_JS, "hit index", zone);
 
     // Swap under lock
     InstanceSnapshot *old_snap = NULL;
+    HitIndex *stale_index = NULL;
+    zone = prof_begin();
     vd_mutex_lock(snapshot_mutex);
     old_snap = front_snapshot;
     front_snapshot = new_snap;
+    front_generation++;
+    apply_pending_front_registry();
+    stale_index = publish_hit_index_locked(hit_index);
     vd_mutex_unlock(snapshot_mutex);
+    published_generation = committed_generation;
+    latency_published(front_generation);
+    prof_end(PROF_THREAD_JS, "publish", zone);
 
-    // Free old snapshot (outside lock, safe because UI no longer references it)
+    // Release old snapshot (outside lock, safe because UI no longer references it)
+    zone = prof_begin();
     free_snapshot(old_snap);
+    hit_index_free(stale_index);
+    drain_pending_releases();
+    prof_end(PROF_THREAD_JS, "release", zone);
+    stats.swaps++;
+    stats.swap_seconds += GetTime() - swap_start;
+}
+
+void instance_tree_get_stats(InstanceTreeStats *out)
+{
+    *out = stats;
 }
 
 void instance_tree_clear(void)
 {
-    int back_count = arrlen(back_root_children);
+    // Every live instance (attached or not) owns a back slot, so freeing the slots frees the tree.
+    int back_count = arrlen(back_slots);
     for (int i = 0; i < back_count; i++) {
-        free_instance_tree(back_root_children[i]);
+        instance_back_free(back_slots[i]);
     }
+    arrfree(back_slots);
+    back_slots = NULL;
     arrfree(back_root_children);
     back_root_children = NULL;
-    shfree(back_registry);
-    back_registry = NULL;
 
     InstanceSnapshot *old_snap = NULL;
+    FrontSlot *old_slots = NULL;
+    HitIndex *stale_index = NULL;
     vd_mutex_lock(snapshot_mutex);
     old_snap = front_snapshot;
     front_snapshot = NULL;
+    front_generation++;
+    old_slots = front_slots;
+    front_slots = NULL;
+    stale_index = publish_hit_index_locked(NULL);
     vd_mutex_unlock(snapshot_mutex);
     free_snapshot(old_snap);
+    hit_index_free(stale_index);
+
+    int slot_count = arrlen(old_slots);
+    for (int i = 0; i < slot_count; i++) {
+        release_snapshot_instance(old_slots[i].value);
+    }
+    arrfree(old_slots);
+
+    int put_count = arrlen(pending_front_puts);
+    for (int i = 0; i < put_count; i++) {
+        release_snapshot_instance(pending_front_puts[i].copy);
+    }
+    arrsetlen(pending_front_puts, 0);
+    arrsetlen(pending_front_dels, 0);
+    drain_pending_releases();
+
+    back_generation++;
+    published_generation = 0;
+    committed_generation = 0;
 }
 
 void instance_tree_render_lock(void)
@@ -277,245 +450,209 @@ void instance_tree_render_unlock(void)
     vd_mutex_unlock(snapshot_mutex);
 }
 
+unsigned int instance_tree_front_generation(void)
+{
+    return front_generation;
+}
+
 ReactInstance **instance_get_root_children(void)
 {
     return front_snapshot ? front_snapshot->root_children : NULL;
 }
 
 // For hit testing, find in front buffer (UI thread) - must be called under lock
-static ReactInstance *find_front_instance_unlocked(InstanceSnapshot *snap, const char *id)
+static FrontSlot *find_front_slot_unlocked(InstanceHandle id)
+{
+    if (id == INSTANCE_HANDLE_NONE) return NULL;
+    uint32_t index = instance_handle_index(id);
+    if (index >= arrlenu(front_slots)) return NULL;
+    FrontSlot *slot = &front_slots[index];
+    return slot->value && slot->value->id == id ? slot : NULL;
+}
+
+static ReactInstance *find_front_instance_unlocked(InstanceHandle id)
 {
-    if (!id || !snap) return NULL;
-    int idx = shgeti(snap->registry, id);
-    if (idx < 0) return NULL;
-    return snap->registry[idx].value;
+    FrontSlot *slot = find_front_slot_unlocked(id);
+    return slot ? slot->value : NULL;
 }
 
-bool instance_exists(const char *id)
+bool instance_exists(InstanceHandle id)
 {
-    if (!id) return false;
+    if (id == INSTANCE_HANDLE_NONE) return false;
     vd_mutex_lock(snapshot_mutex);
-    bool exists = front_snapshot && find_front_instance_unlocked(front_snapshot, id) != NULL;
+    bool exists = front_snapshot && find_front_instance_unlocked(id) != NULL;
     vd_mutex_unlock(snapshot_mutex);
     return exists;
 }
 
-// Hit testing
-static const char *hit_test_recursive(ReactInstance **children, int x, int y, int offset_x, int offset_y);
-
-static const char *hit_test_instance(ReactInstance *inst, int x, int y, int offset_x, int offset_y)
+// Hit index of a snapshot: rectangles of hittable instances in paint order, the content of each
+// scroll container in a layer of its own (see hit_grid.h). Built on the JS thread by
+// instance_tree_swap, outside the render lock.
+static void index_instance(HitIndex *index, int layer, ReactInstance *inst, int offset_x, int offset_y)
 {
-    if (!inst) return NULL;
+    if (!inst) return;
 
     if (inst->type == NT_RECT) {
         RectProps *r = &inst->props.rect;
         int abs_x = offset_x + r->x;
         int abs_y = offset_y + r->y;
-
-        const char *child_hit = hit_test_recursive(inst->children, x, y, abs_x, abs_y);
-        if (child_hit) return child_hit;
-
-        if (x >= abs_x && x < abs_x + r->width && y >= abs_y && y < abs_y + r->height) {
-            return inst->id;
+        hit_index_add(index, layer, inst->id, abs_x, abs_y, r->width, r->height, HIT_POINTER, HIT_LAYER_NONE);
+        int count = arrlen(inst->children);
+        for (int i = 0; i < count; i++) {
+            index_instance(index, layer, inst->children[i], abs_x, abs_y);
         }
     } else if (inst->type == NT_BUTTON) {
         ButtonProps *b = &inst->props.button;
-        int abs_x = offset_x + b->x;
-        int abs_y = offset_y + b->y;
-
-        if (x >= abs_x && x < abs_x + b->width && y >= abs_y && y < abs_y + b->height) {
-            return inst->id;
-        }
+        hit_index_add(index, layer, inst->id, offset_x + b->x, offset_y + b->y, b->width, b->height,
+                      HIT_POINTER | HIT_FOCUS, HIT_LAYER_NONE);
     } else if (inst->type == NT_SCROLL) {
         ScrollProps *s = &inst->props.scroll;
         int abs_x = offset_x + s->x;
         int abs_y = offset_y + s->y;
+        int content = hit_index_add_layer(index, inst->id, abs_x + s->padding, abs_y + s->padding);
+        hit_index_add(index, layer, inst->id, abs_x, abs_y, s->width, s->height, HIT_POINTER | HIT_SCROLL | HIT_FOCUS,
+                      content);
+        if (content == HIT_LAYER_NONE) return;
 
-        bool inside = x >= abs_x && x < abs_x + s->width && y >= abs_y && y < abs_y + s->height;
-        if (!inside) return NULL;
-
-        int content_x = abs_x + s->padding;
-        int content_y = abs_y + s->padding - scroll_get_offset(inst->id);
-
-        const char *hit = NULL;
         int flow_y = 0;
         int count = arrlen(inst->children);
         for (int i = 0; i < count; i++) {
             ReactInstance *child = inst->children[i];
             if (!child) continue;
             int base_y = 0;
-            int child_offset_y = content_y;
-            if (scroll_flow_step(child, s->gap, &flow_y, &base_y)) {
-                child_offset_y = content_y + base_y;
-            }
-            const char *child_hit = hit_test_instance(child, x, y, content_x, child_offset_y);
-            if (child_hit) hit = child_hit; /* later children render on top */
+            int child_offset_y = 0;
+            if (scroll_flow_step(child, s->gap, &flow_y, &base_y)) child_offset_y = base_y;
+            index_instance(index, content, child, 0, child_offset_y);
         }
-        if (hit) return hit;
-
-        return inst->id;
     }
-
-    return NULL;
 }
 
-static const char *hit_test_recursive(ReactInstance **children, int x, int y, int offset_x, int offset_y)
+static HitIndex *build_hit_index(ReactInstance **root_children)
 {
-    if (!children) return NULL;
-    int count = arrlen(children);
-
-    for (int i = count - 1; i >= 0; i--) {
-        const char *hit = hit_test_instance(children[i], x, y, offset_x, offset_y);
-        if (hit) return hit;
+    HitIndex *index = hit_index_create();
+    if (!index) return NULL;
+    int count = arrlen(root_children);
+    for (int i = 0; i < count; i++) {
+        index_instance(index, 0, root_children[i], 0, 0);
     }
+    hit_index_build(index);
+    return index;
+}
 
-    return NULL;
+// Hand the index of a new snapshot (or NULL for none) to the UI thread. Must be called under the
+// snapshot lock; returns a pending index the UI thread never took, to be freed after unlocking.
+static HitIndex *publish_hit_index_locked(HitIndex *index)
+{
+    HitIndex *stale = hit_index_pending ? pending_hit_index : NULL;
+    pending_hit_index = index;
+    hit_index_pending = true;
+    return stale;
 }
 
-const char *instance_hit_test(int x, int y)
+// The UI thread's copy of the hit index; queried without the render lock. UI thread only.
+static HitIndex *front_hit_index = NULL;
+static unsigned int front_hit_serial = 0;
+
+// Take the index of the latest publish, if any. The lock is held only to swap a pointer.
+static void ensure_front_index(void)
 {
+    HitIndex *taken = NULL;
+    bool took = false;
     vd_mutex_lock(snapshot_mutex);
-    const char *result = NULL;
-    if (front_snapshot) {
-        result = hit_test_recursive(front_snapshot->root_children, x, y, 0, 0);
+    if (hit_index_pending) {
+        taken = pending_hit_index;
+        pending_hit_index = NULL;
+        hit_index_pending = false;
+        took = true;
     }
     vd_mutex_unlock(snapshot_mutex);
-    return result;
+    if (!took) return;
+    hit_index_free(front_hit_index);
+    front_hit_index = taken;
+    front_hit_serial++;
 }
 
-static bool rect_intersects_clip(int x, int y, int width, int height, bool has_clip, int clip_x, int clip_y,
-                                 int clip_width, int clip_height)
-{
-    if (!has_clip) return true;
-    return x < clip_x + clip_width && x + width > clip_x && y < clip_y + clip_height && y + height > clip_y;
-}
-
-static void add_focusable_if_visible(const char *id, int x, int y, int width, int height, bool has_clip, int clip_x,
-                                     int clip_y, int clip_width, int clip_height, FocusableElement **out_elems)
-{
-    if (!id || !rect_intersects_clip(x, y, width, height, has_clip, clip_x, clip_y, clip_width, clip_height)) return;
+// Visible focusables in tree order, in screen coordinates. Collected from the hit index on the
+// first instance_focus_next() after a publish or scroll, so frames without D-pad input never pay
+// for it.
+static HitRect *focus_elems = NULL;
+static unsigned int focus_hit_serial = 0;
+static unsigned int focus_scroll_generation = 0;
+static bool focus_collected = false;
 
-    FocusableElement elem = {.id = strdup(id), .x = x, .y = y, .width = width, .height = height};
-    arrput(*out_elems, elem);
-}
-
-static bool intersect_clip(bool has_a, int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh, bool *has_out,
-                           int *out_x, int *out_y, int *out_w, int *out_h)
+// Weighted distance from a to b along dir (favors elements aligned with the direction),
+// or a negative value when b is not in that direction.
+static float focus_score(const HitRect *a, const HitRect *b, FocusDirection dir)
 {
-    if (!has_a) {
-        *has_out = true;
-        *out_x = bx;
-        *out_y = by;
-        *out_w = bw;
-        *out_h = bh;
-        return bw > 0 && bh > 0;
+    int dx = (b->x + b->width / 2) - (a->x + a->width / 2);
+    int dy = (b->y + b->height / 2) - (a->y + a->height / 2);
+    switch (dir) {
+    case FOCUS_UP:
+        return dy < 0 ? fabsf((float)dy) + fabsf((float)dx) * 2.0f : -1.0f;
+    case FOCUS_DOWN:
+        return dy > 0 ? fabsf((float)dy) + fabsf((float)dx) * 2.0f : -1.0f;
+    case FOCUS_LEFT:
+        return dx < 0 ? fabsf((float)dx) + fabsf((float)dy) * 2.0f : -1.0f;
+    case FOCUS_RIGHT:
+        return dx > 0 ? fabsf((float)dx) + fabsf((float)dy) * 2.0f : -1.0f;
     }
-
-    int x1 = ax > bx ? ax : bx;
-    int y1 = ay > by ? ay : by;
-    int x2 = ax + aw < bx + bw ? ax + aw : bx + bw;
-    int y2 = ay + ah < by + bh ? ay + ah : by + bh;
-
-    *has_out = true;
-    *out_x = x1;
-    *out_y = y1;
-    *out_w = x2 - x1;
-    *out_h = y2 - y1;
-    return *out_w > 0 && *out_h > 0;
+    return -1.0f;
 }
 
-static void collect_focusable_instance(ReactInstance *inst, int offset_x, int offset_y, bool has_clip, int clip_x,
-                                       int clip_y, int clip_width, int clip_height, FocusableElement **out_elems);
-
-// Focusable element collection for gamepad navigation
-static void collect_focusable_recursive(ReactInstance **children, int offset_x, int offset_y, bool has_clip, int clip_x,
-                                        int clip_y, int clip_width, int clip_height, FocusableElement **out_elems)
+static void ensure_focus_elems(void)
 {
-    if (!children) return;
-    int count = arrlen(children);
-
-    for (int i = 0; i < count; i++) {
-        collect_focusable_instance(children[i], offset_x, offset_y, has_clip, clip_x, clip_y, clip_width, clip_height,
-                                   out_elems);
-    }
+    ensure_front_index();
+    unsigned int scroll_gen = scroll_generation();
+    if (focus_collected && focus_hit_serial == front_hit_serial && focus_scroll_generation == scroll_gen) return;
+    arrsetlen(focus_elems, 0);
+    hit_index_collect(front_hit_index, HIT_FOCUS, &focus_elems);
+    focus_hit_serial = front_hit_serial;
+    focus_scroll_generation = scroll_gen;
+    focus_collected = true;
 }
 
-static void collect_focusable_instance(ReactInstance *inst, int offset_x, int offset_y, bool has_clip, int clip_x,
-                                       int clip_y, int clip_width, int clip_height, FocusableElement **out_elems)
+InstanceHandle instance_hit_test(int x, int y)
 {
-    if (!inst) return;
-
-    if (inst->type == NT_BUTTON) {
-        ButtonProps *b = &inst->props.button;
-        add_focusable_if_visible(inst->id, offset_x + b->x, offset_y + b->y, b->width, b->height, has_clip, clip_x,
-                                 clip_y, clip_width, clip_height, out_elems);
-    } else if (inst->type == NT_RECT) {
-        RectProps *r = &inst->props.rect;
-        collect_focusable_recursive(inst->children, offset_x + r->x, offset_y + r->y, has_clip, clip_x, clip_y,
-                                    clip_width, clip_height, out_elems);
-    } else if (inst->type == NT_SCROLL) {
-        ScrollProps *s = &inst->props.scroll;
-        int abs_x = offset_x + s->x;
-        int abs_y = offset_y + s->y;
-        add_focusable_if_visible(inst->id, abs_x, abs_y, s->width, s->height, has_clip, clip_x, clip_y, clip_width,
-                                 clip_height, out_elems);
-
-        bool child_has_clip = false;
-        int child_clip_x = 0, child_clip_y = 0, child_clip_width = 0, child_clip_height = 0;
-        if (!intersect_clip(has_clip, clip_x, clip_y, clip_width, clip_height, abs_x, abs_y, s->width, s->height,
-                            &child_has_clip, &child_clip_x, &child_clip_y, &child_clip_width, &child_clip_height)) {
-            return;
-        }
-
-        int content_x = abs_x + s->padding;
-        int content_y = abs_y + s->padding - scroll_get_offset(inst->id);
-        int flow_y = 0;
-        int child_count = arrlen(inst->children);
-        for (int child_i = 0; child_i < child_count; child_i++) {
-            ReactInstance *child = inst->children[child_i];
-            if (!child) continue;
-
-            int base_y = 0;
-            int child_offset_y = content_y;
-            if (scroll_flow_step(child, s->gap, &flow_y, &base_y)) {
-                child_offset_y = content_y + base_y;
-            }
-            collect_focusable_instance(child, content_x, child_offset_y, child_has_clip, child_clip_x, child_clip_y,
-                                       child_clip_width, child_clip_height, out_elems);
-        }
-    }
+    ensure_front_index();
+    return hit_index_query(front_hit_index, x, y, HIT_POINTER);
 }
 
-FocusableElement *get_focusable_elements(int *count)
+InstanceHandle instance_focus_next(InstanceHandle from, FocusDirection dir)
 {
-    FocusableElement *elems = NULL;
+    ensure_focus_elems();
+    int count = arrlen(focus_elems);
+    if (count == 0) return INSTANCE_HANDLE_NONE;
 
-    vd_mutex_lock(snapshot_mutex);
-    if (front_snapshot) {
-        collect_focusable_recursive(front_snapshot->root_children, 0, 0, false, 0, 0, 0, 0, &elems);
+    const HitRect *current = NULL;
+    for (int i = 0; i < count && from; i++) {
+        if (focus_elems[i].id == from) {
+            current = &focus_elems[i];
+            break;
+        }
     }
-    vd_mutex_unlock(snapshot_mutex);
-
-    *count = arrlen(elems);
-    return elems;
-}
+    if (!current) return focus_elems[0].id;
 
-void free_focusable_elements(FocusableElement *elems, int count)
-{
+    InstanceHandle best_id = INSTANCE_HANDLE_NONE;
+    float best_score = 1e9f;
     for (int i = 0; i < count; i++) {
-        free(elems[i].id);
+        if (focus_elems[i].id == from) continue;
+        float score = focus_score(current, &focus_elems[i], dir);
+        if (score >= 0.0f && score < best_score) {
+            best_score = score;
+            best_id = focus_elems[i].id;
+        }
     }
-    arrfree(elems);
+    return best_id;
 }
 
-bool instance_scroll_metrics(const char *id, int *viewport_height, int *content_height)
+bool instance_scroll_metrics(InstanceHandle id, int *viewport_height, int *content_height)
 {
-    if (!id) return false;
+    if (id == INSTANCE_HANDLE_NONE) return false;
 
     bool found = false;
     vd_mutex_lock(snapshot_mutex);
     if (front_snapshot) {
-        ReactInstance *inst = find_front_instance_unlocked(front_snapshot, id);
+        ReactInstance *inst = find_front_instance_unlocked(id);
         if (inst && inst->type == NT_SCROLL) {
             *viewport_height = inst->props.scroll.height;
             *content_height = scroll_content_height(inst);
@@ -526,148 +663,167 @@ bool instance_scroll_metrics(const char *id, int *viewport_height, int *content_
     return found;
 }
 
-static ReactInstance *scroll_at_instance(ReactInstance *inst, int x, int y, int offset_x, int offset_y)
-{
-    if (!inst) return NULL;
-
-    if (inst->type == NT_RECT) {
-        RectProps *r = &inst->props.rect;
-        ReactInstance *found = NULL;
-        int count = arrlen(inst->children);
-        for (int i = 0; i < count; i++) {
-            ReactInstance *hit = scroll_at_instance(inst->children[i], x, y, offset_x + r->x, offset_y + r->y);
-            if (hit) found = hit;
-        }
-        return found;
-    }
-
-    if (inst->type != NT_SCROLL) return NULL;
-
-    ScrollProps *s = &inst->props.scroll;
-    int abs_x = offset_x + s->x;
-    int abs_y = offset_y + s->y;
-    if (x < abs_x || x >= abs_x + s->width || y < abs_y || y >= abs_y + s->height) return NULL;
-
-    /* Prefer a nested scroll container under the point. */
-    ReactInstance *found = inst;
-    int content_x = abs_x + s->padding;
-    int content_y = abs_y + s->padding - scroll_get_offset(inst->id);
-    int flow_y = 0;
-    int count = arrlen(inst->children);
-    for (int i = 0; i < count; i++) {
-        ReactInstance *child = inst->children[i];
-        if (!child) continue;
-        int base_y = 0;
-        int child_offset_y = content_y;
-        if (scroll_flow_step(child, s->gap, &flow_y, &base_y)) {
-            child_offset_y = content_y + base_y;
-        }
-        ReactInstance *hit = scroll_at_instance(child, x, y, content_x, child_offset_y);
-        if (hit) found = hit;
-    }
-    return found;
-}
-
-char *instance_scroll_for_descendant(const char *id)
+InstanceHandle instance_scroll_for_descendant(InstanceHandle id)
 {
-    if (!id) return NULL;
-
-    char *result = NULL;
+    InstanceHandle result = INSTANCE_HANDLE_NONE;
     vd_mutex_lock(snapshot_mutex);
     if (front_snapshot) {
-        ReactInstance *inst = find_front_instance_unlocked(front_snapshot, id);
-        while (inst) {
-            if (inst->type == NT_SCROLL && inst->id) {
-                result = strdup(inst->id);
+        FrontSlot *slot = find_front_slot_unlocked(id);
+        while (slot) {
+            if (slot->value->type == NT_SCROLL) {
+                result = slot->value->id;
                 break;
             }
-            inst = inst->parent;
+            slot = find_front_slot_unlocked(slot->parent);
         }
     }
     vd_mutex_unlock(snapshot_mutex);
     return result;
 }
 
-char *instance_scroll_at(int x, int y)
+InstanceHandle instance_scroll_at(int x, int y)
 {
-    char *result = NULL;
-    vd_mutex_lock(snapshot_mutex);
-    if (front_snapshot) {
-        ReactInstance *found = NULL;
-        int count = arrlen(front_snapshot->root_children);
-        for (int i = 0; i < count; i++) {
-            ReactInstance *hit = scroll_at_instance(front_snapshot->root_children[i], x, y, 0, 0);
-            if (hit) found = hit;
-        }
-        if (found && found->id) result = strdup(found->id);
-    }
-    vd_mutex_unlock(snapshot_mutex);
-    return result;
+    ensure_front_index();
+    return hit_index_query(front_hit_index, x, y, HIT_SCROLL);
 }
 
 // Back-buffer operations (JS thread only)
-ReactInstance *instance_back_find(const char *id)
+ReactInstance *instance_back_find(InstanceHandle id)
 {
-    if (!id) return NULL;
-    int idx = shgeti(back_registry, id);
-    if (idx < 0) return NULL;
-    return back_registry[idx].value;
+    if (id == INSTANCE_HANDLE_NONE) return NULL;
+    uint32_t index = instance_handle_index(id);
+    if (index >= arrlenu(back_slots)) return NULL;
+    ReactInstance *inst = back_slots[index];
+    return inst && inst->id == id ? inst : NULL;
 }
 
-void instance_back_put(ReactInstance *inst)
+bool instance_back_put(ReactInstance *inst)
 {
-    if (!inst || !inst->id) return;
-    shput(back_registry, inst->id, inst);
+    if (!inst || inst->id == INSTANCE_HANDLE_NONE) return false;
+    uint32_t index = instance_handle_index(inst->id);
+    uint32_t old_len = arrlenu(back_slots);
+    if (index >= old_len) {
+        arrsetlen(back_slots, index + 1);
+        memset(&back_slots[old_len], 0, (index + 1 - old_len) * sizeof(ReactInstance *));
+    }
+    // Overwriting a live instance would leak it and leave its children pointing at it.
+    if (back_slots[index]) return false;
+    inst->dirty = true;
+    back_slots[index] = inst;
+    return true;
 }
 
-void instance_back_del(const char *id)
+void instance_back_del(InstanceHandle id)
 {
-    if (!id) return;
-    shdel(back_registry, id);
+    if (!instance_back_find(id)) return;
+    // Drop the published copy from the front registry on the next swap.
+    arrput(pending_front_dels, id);
+    back_slots[instance_handle_index(id)] = NULL;
+    back_generation++;
 }
 
-void instance_back_root_append(ReactInstance *child)
+void instance_back_mark_dirty(ReactInstance *inst)
 {
-    if (!child) return;
-    child->parent = NULL;
-    arrput(back_root_children, child);
+    back_generation++;
+    if (!inst) return;
+    inst->dirty = true;
+    // A dirty instance always has dirty ancestors, so stop at the first one already marked.
+    for (ReactInstance *it = inst->parent; it && !it->dirty; it = it->parent) {
+        it->dirty = true;
+    }
 }
 
-void instance_back_root_insert(ReactInstance *child, ReactInstance *before)
+static void remove_from_children(ReactInstance ***children, ReactInstance *child)
 {
-    if (!child) return;
-    child->parent = NULL;
+    int count = arrlen(*children);
+    for (int i = 0; i < count; i++) {
+        if ((*children)[i] == child) {
+            arrdel(*children, i);
+            break;
+        }
+    }
+}
 
-    int count = arrlen(back_root_children);
+static void insert_into_children(ReactInstance ***children, ReactInstance *child, ReactInstance *before)
+{
+    int count = arrlen(*children);
     int insert_idx = count;
     for (int i = 0; i < count; i++) {
-        if (back_root_children[i] == before) {
+        if ((*children)[i] == before) {
             insert_idx = i;
             break;
         }
     }
+    arrins(*children, insert_idx, child);
+}
 
-    arrins(back_root_children, insert_idx, child);
+// Appending or inserting an attached child moves it (DOM semantics), so detach it first.
+static void detach_child(ReactInstance *child)
+{
+    if (child->parent) {
+        remove_from_children(&child->parent->children, child);
+        instance_back_mark_dirty(child->parent);
+    } else {
+        remove_from_children(&back_root_children, child);
+    }
+    child->parent = NULL;
 }
 
-void instance_back_root_remove(ReactInstance *child)
+void instance_back_root_append(ReactInstance *child)
 {
     if (!child) return;
+    detach_child(child);
+    arrput(back_root_children, child);
+    instance_back_mark_dirty(child);
+}
 
-    int count = arrlen(back_root_children);
-    for (int i = 0; i < count; i++) {
-        if (back_root_children[i] == child) {
-            arrdel(back_root_children, i);
-            break;
-        }
-    }
+void instance_back_root_insert(ReactInstance *child, ReactInstance *before)
+{
+    if (!child) return;
+    detach_child(child);
+    insert_into_children(&back_root_children, child, before);
+    instance_back_mark_dirty(child);
+}
+
+void instance_back_root_remove(ReactInstance *child)
+{
+    if (!child) return;
+    remove_from_children(&back_root_children, child);
     child->parent = NULL;
+    back_generation++;
 }
 
 void instance_back_root_clear(void)
 {
     arrfree(back_root_children);
     back_root_children = NULL;
+    back_generation++;
+}
+
+void instance_back_append_child(ReactInstance *parent, ReactInstance *child)
+{
+    if (!parent || !child) return;
+    detach_child(child);
+    child->parent = parent;
+    arrput(parent->children, child);
+    instance_back_mark_dirty(child);
+}
+
+void instance_back_insert_child(ReactInstance *parent, ReactInstance *child, ReactInstance *before)
+{
+    if (!parent || !child) return;
+    detach_child(child);
+    child->parent = parent;
+    insert_into_children(&parent->children, child, before);
+    instance_back_mark_dirty(child);
+}
+
+void instance_back_remove_child(ReactInstance *parent, ReactInstance *child)
+{
+    if (!parent || !child) return;
+    remove_from_children(&parent->children, child);
+    child->parent = NULL;
+    instance_back_mark_dirty(parent);
 }
 
 static void collect_text_recursive(const ReactInstance *inst, char *buffer, size_t buffer_size)
@@ -2,8 +2,25 @@
 #define INSTANCE_TREE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <raylib.h>
 
+// Instances are identified by 32-bit handles allocated by the JS reconciler: the low
+// bits index a slot in the registries, the high bits are a generation so a handle to a
+// destroyed instance never matches the slot's next occupant. 0 means "none" (and the
+// root container where a parent is expected).
+typedef uint32_t InstanceHandle;
+
+#define INSTANCE_HANDLE_NONE 0u
+#define INSTANCE_HANDLE_INDEX_BITS 20
+#define INSTANCE_HANDLE_INDEX_MASK ((1u << INSTANCE_HANDLE_INDEX_BITS) - 1u)
+
+static inline uint32_t instance_handle_index(InstanceHandle handle)
+{
+    return handle & INSTANCE_HANDLE_INDEX_MASK;
+}
+
 typedef enum { NT_RECT = 1, NT_TEXT = 2, NT_BUTTON = 3, NT_RAW_TEXT = 4, NT_SCROLL = 5, NT_IMAGE = 6 } NodeType;
 
 typedef struct {
@@ -53,10 +70,17 @@ typedef struct {
     int x, y, width, height;
 } ImageProps;
 
+// Instance strings (string props) are immutable and reference counted so
+// snapshot copies share them with the back buffer. Never modify one in place.
+char *instance_string_new(const char *str);
+char *instance_string_retain(char *str);
+void instance_string_release(char *str);
+
 typedef struct ReactInstance ReactInstance;
+typedef struct TextLayout TextLayout;
 
 struct ReactInstance {
-    char *id;
+    InstanceHandle id;
     NodeType type;
     union {
         RectProps rect;
@@ -68,6 +92,19 @@ struct ReactInstance {
     } props;
     ReactInstance **children;
     ReactInstance *parent;
+
+    // Back buffer only: set when this node or one of its descendants changed since the
+    // last swap. Clean nodes reuse their cached snapshot copy instead of being re-copied.
+    bool dirty;
+    ReactInstance *snapshot;
+
+    // Snapshot copies only: references held by parent copies, snapshot roots, and the
+    // owning back node's cache. Copies are shared between consecutive snapshots.
+    int refcount;
+
+    // Snapshot copies of text instances only: wrapped lines, shared with the previous copy
+    // when the text and its metrics are unchanged, else built when the copy is made.
+    TextLayout *text_layout;
 };
 
 // Minimal column layout for scroll containers. Rect, button, and image children
@@ -81,20 +118,23 @@ int scroll_content_height(const ReactInstance *scroll);
 
 // Look up a scroll container in the front snapshot (thread-safe).
 // Returns false when id is not a scroll container.
-bool instance_scroll_metrics(const char *id, int *viewport_height, int *content_height);
+bool instance_scroll_metrics(InstanceHandle id, int *viewport_height, int *content_height);
 
 // Nearest scroll container containing this instance, or the instance itself if it is a scroll.
-// Returns a malloc'd id (caller frees) or NULL.
-char *instance_scroll_for_descendant(const char *id);
+// Returns INSTANCE_HANDLE_NONE when there is none.
+InstanceHandle instance_scroll_for_descendant(InstanceHandle id);
 
-// Deepest scroll container whose viewport contains (x, y).
-// Returns a malloc'd id (caller frees) or NULL.
-char *instance_scroll_at(int x, int y);
+// Deepest scroll container whose viewport contains (x, y), or INSTANCE_HANDLE_NONE.
+InstanceHandle instance_scroll_at(int x, int y);
 
 // Initialize the instance tree (call once at startup before any threads)
 void instance_tree_init(void);
 
-// Swap back buffer to front buffer (call from JS thread after mutations)
+// Mark the current back buffer as a complete React commit (JS thread).
+void instance_tree_commit(void);
+
+// Publish the back buffer as the new front snapshot (call from JS thread between tasks).
+// Does nothing unless a commit was marked since the last swap.
 void instance_tree_swap(void);
 void instance_tree_clear(void);
 
@@ -104,29 +144,50 @@ void instance_tree_render_unlock(void);
 
 // Get root children for rendering (must hold render lock)
 ReactInstance **instance_get_root_children(void);
+// Bumped each time a snapshot is published (must hold render lock)
+unsigned int instance_tree_front_generation(void);
 
-// Hit testing (thread-safe, acquires lock internally)
-const char *instance_hit_test(int x, int y);
-bool instance_exists(const char *id);
+// Hit testing (UI thread only, answered from an index built with each published snapshot)
+InstanceHandle instance_hit_test(int x, int y);
+bool instance_exists(InstanceHandle id);
 
-// Focusable elements for gamepad navigation
-typedef struct {
-    char *id;
-    int x, y, width, height;
-} FocusableElement;
+// Gamepad focus navigation
+typedef enum { FOCUS_UP, FOCUS_DOWN, FOCUS_LEFT, FOCUS_RIGHT } FocusDirection;
 
-FocusableElement *get_focusable_elements(int *count);
-void free_focusable_elements(FocusableElement *elems, int count);
+// Nearest visible focusable from `from` in direction dir, or the first focusable when `from`
+// is not visible. Linear in the visible focusables, which are collected on the first call after a
+// publish or scroll.
+InstanceHandle instance_focus_next(InstanceHandle from, FocusDirection dir);
 
 // Back-buffer operations (called from JS thread only)
-ReactInstance *instance_back_find(const char *id);
-void instance_back_put(ReactInstance *inst);
-void instance_back_del(const char *id);
+ReactInstance *instance_back_find(InstanceHandle id);
+// Register inst under its handle. False (and nothing registered) when the handle's slot is taken.
+bool instance_back_put(ReactInstance *inst);
+void instance_back_del(InstanceHandle id);
 void instance_back_free(ReactInstance *inst);
 void instance_back_root_append(ReactInstance *child);
 void instance_back_root_insert(ReactInstance *child, ReactInstance *before);
 void instance_back_root_remove(ReactInstance *child);
 void instance_back_root_clear(void);
+void instance_back_append_child(ReactInstance *parent, ReactInstance *child);
+void instance_back_insert_child(ReactInstance *parent, ReactInstance *child, ReactInstance *before);
+void instance_back_remove_child(ReactInstance *parent, ReactInstance *child);
+
+// Mark an instance (and its ancestors) as changed so the next swap re-copies it.
+// Call after mutating props of a back-buffer instance in place.
+void instance_back_mark_dirty(ReactInstance *inst);
+
+// Running totals for benchmarks. Read on the JS thread (or once it is stopped).
+typedef struct {
+    unsigned long commits;         // instance_tree_commit() calls
+    unsigned long swaps;           // published snapshots
+    double swap_seconds;           // time spent in publishing swaps
+    unsigned long snapshot_copies; // snapshot copies made (reused clean copies are not counted)
+    long snapshot_nodes;           // live snapshot copies
+    size_t snapshot_bytes;         // heap held by live snapshot copies, excluding shared strings
+} InstanceTreeStats;
+
+void instance_tree_get_stats(InstanceTreeStats *out);
 
 // Read-only inspection of the front snapshot (thread-safe, for integration tests and diagnostics).
 void instance_tree_collect_text(char *buffer, size_t buffer_size);
@@ -4,41 +4,38 @@
 #include "scroll.h"
 
 typedef struct {
-    char *key;
+    InstanceHandle key;
     int value;
 } ScrollEntry;
 
 static ScrollEntry *offsets = NULL;
-static bool map_initialized = false;
+static unsigned int generation = 0;
 
-static void ensure_map(void)
+int scroll_get_offset(InstanceHandle id)
 {
-    if (!map_initialized) {
-        sh_new_strdup(offsets);
-        map_initialized = true;
-    }
-}
-
-int scroll_get_offset(const char *id)
-{
-    if (!id) return 0;
-    ensure_map();
-    int idx = shgeti(offsets, id);
+    if (id == INSTANCE_HANDLE_NONE) return 0;
+    int idx = hmgeti(offsets, id);
     return idx >= 0 ? offsets[idx].value : 0;
 }
 
-void scroll_set_offset(const char *id, int offset)
+void scroll_set_offset(InstanceHandle id, int offset)
 {
-    if (!id) return;
-    ensure_map();
+    if (id == INSTANCE_HANDLE_NONE) return;
     if (offset < 0) offset = 0;
-    shput(offsets, id, offset);
+    int idx = hmgeti(offsets, id);
+    if (idx >= 0 && offsets[idx].value == offset) return;
+    hmput(offsets, id, offset);
+    generation++;
 }
 
 void scroll_reset(void)
 {
-    if (!map_initialized) return;
-    shfree(offsets);
+    hmfree(offsets);
     offsets = NULL;
-    map_initialized = false;
+    generation++;
+}
+
+unsigned int scroll_generation(void)
+{
+    return generation;
 }
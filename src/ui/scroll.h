@@ -1,13 +1,18 @@
 #ifndef SCROLL_H
 #define SCROLL_H
 
-/* Scroll offsets for scroll containers, keyed by instance id.
+#include "instance_tree.h"
+
+/* Scroll offsets for scroll containers, keyed by instance handle.
  * UI-thread only (render + input polling run on the same thread). */
 
-int scroll_get_offset(const char *id);
-void scroll_set_offset(const char *id, int offset);
+int scroll_get_offset(InstanceHandle id);
+void scroll_set_offset(InstanceHandle id, int offset);
 
 /* Drop all stored offsets (e.g. when the Deck App runtime restarts). */
 void scroll_reset(void);
 
+/* Bumped whenever an offset changes, so state derived from scroll positions can be rebuilt. */
+unsigned int scroll_generation(void);
+
 #endif /* SCROLL_H */
@@ -0,0 +1,306 @@
+#include "text_layout.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "stb_ds.h"
+#include "fonts.h"
+
+#define TEXT_SPACING 1.0f
+
+// Unscaled glyph advances and codepoint count of a span, as MeasureTextEx accumulates them.
+// Spans are additive: the metrics of a + b are the sums of their fields.
+typedef struct {
+    float advance;
+    int glyphs;
+} SpanMetrics;
+
+static SpanMetrics measure_span(Font font, const char *text, int start, int end)
+{
+    SpanMetrics m = {0};
+    for (int i = start; i < end;) {
+        int bytes = 0;
+        int codepoint = GetCodepointNext(&text[i], &bytes);
+        int index = GetGlyphIndex(font, codepoint);
+        if (font.glyphs[index].advanceX > 0) {
+            m.advance += (float)font.glyphs[index].advanceX;
+        } else {
+            m.advance += font.recs[index].width + (float)font.glyphs[index].offsetX;
+        }
+        m.glyphs++;
+        i += bytes > 0 ? bytes : 1;
+    }
+    return m;
+}
+
+static SpanMetrics span_join(SpanMetrics a, SpanMetrics b)
+{
+    return (SpanMetrics){a.advance + b.advance, a.glyphs + b.glyphs};
+}
+
+static int span_width(Font font, int font_size, SpanMetrics m)
+{
+    if (m.glyphs == 0 || font.baseSize <= 0) return 0;
+    float width = m.advance * ((float)font_size / (float)font.baseSize) + (float)(m.glyphs - 1) * TEXT_SPACING;
+    return (int)(width + 0.5f);
+}
+
+static int text_glyph_height(Font font, int font_size)
+{
+    Vector2 size = MeasureTextEx(font, "Ay", (float)font_size, TEXT_SPACING);
+    int height = (int)(size.y + 0.5f);
+    return height > 0 ? height : font_size;
+}
+
+static int text_line_height(const TextProps *t)
+{
+    int font_size = t->font_size > 0 ? t->font_size : 30;
+    if (t->line_height > 0) return t->line_height;
+    return text_glyph_height(font_registry_get(t->font_name), font_size) + 4;
+}
+
+static int text_block_height(int line_count, int line_height, Font font, int font_size)
+{
+    if (line_count <= 0) return 0;
+    if (line_count == 1) return text_glyph_height(font, font_size);
+    return (line_count - 1) * line_height + text_glyph_height(font, font_size);
+}
+
+static void text_layout_add_line(TextLayout *layout, int start, int end, SpanMetrics metrics)
+{
+    int width = span_width(layout->font, layout->font_size, metrics);
+    TextLine line = {.start = start, .length = end - start, .width = width};
+    arrput(layout->lines, line);
+    if (line.width > layout->block_width) layout->block_width = line.width;
+}
+
+// Break a word wider than max_width into chunks of whole codepoints, each at least one glyph.
+static void text_layout_split_word(TextLayout *layout, int word_start, int word_end, int max_width)
+{
+    const char *text = layout->text;
+    int chunk_start = word_start;
+    SpanMetrics chunk = {0};
+    for (int i = word_start; i < word_end;) {
+        int bytes = 0;
+        GetCodepointNext(&text[i], &bytes);
+        if (bytes <= 0) bytes = 1;
+        SpanMetrics next = span_join(chunk, measure_span(layout->font, text, i, i + bytes));
+        if (chunk.glyphs > 0 && span_width(layout->font, layout->font_size, next) > max_width) {
+            text_layout_add_line(layout, chunk_start, i, chunk);
+            chunk_start = i;
+            next = measure_span(layout->font, text, i, i + bytes);
+        }
+        chunk = next;
+        i += bytes;
+    }
+    if (chunk.glyphs > 0) text_layout_add_line(layout, chunk_start, word_end, chunk);
+}
+
+static void text_layout_wrap_word(TextLayout *layout, int start, int end, int max_width)
+{
+    const char *text = layout->text;
+    int line_start = start;
+    int line_end = start;
+    SpanMetrics line = {0};
+    int cursor = start;
+
+    while (cursor < end) {
+        while (cursor < end && text[cursor] == ' ')
+            cursor++;
+        if (cursor >= end) break;
+
+        int word_start = cursor;
+        while (cursor < end && text[cursor] != ' ')
+            cursor++;
+        int word_end = cursor;
+
+        SpanMetrics word = measure_span(layout->font, text, word_start, word_end);
+        if (span_width(layout->font, layout->font_size, word) > max_width) {
+            if (line.glyphs > 0) {
+                text_layout_add_line(layout, line_start, line_end, line);
+                line = (SpanMetrics){0};
+            }
+            text_layout_split_word(layout, word_start, word_end, max_width);
+            continue;
+        }
+
+        SpanMetrics candidate = word;
+        if (line.glyphs > 0) {
+            candidate = span_join(span_join(line, measure_span(layout->font, text, line_end, word_start)), word);
+        }
+
+        if (line.glyphs == 0 || span_width(layout->font, layout->font_size, candidate) > max_width) {
+            if (line.glyphs > 0) text_layout_add_line(layout, line_start, line_end, line);
+            line_start = word_start;
+            line = word;
+        } else {
+            line = candidate;
+        }
+        line_end = word_end;
+    }
+
+    if (line.glyphs > 0) {
+        text_layout_add_line(layout, line_start, line_end, line);
+    } else if (arrlen(layout->lines) == 0) {
+        text_layout_add_line(layout, start, start, line);
+    }
+}
+
+static void text_layout_build(TextLayout *layout, const TextProps *t)
+{
+    const char *text = layout->text ? layout->text : "";
+    int max_width = t->width;
+    bool wrap = max_width > 0 && t->wrap == TEXT_WRAP_WORD;
+
+    int start = 0;
+    for (int i = 0;; i++) {
+        if (text[i] != '\n' && text[i] != '\0') continue;
+        if (wrap && i > start) {
+            text_layout_wrap_word(layout, start, i, max_width);
+        } else {
+            text_layout_add_line(layout, start, i, measure_span(layout->font, text, start, i));
+        }
+        if (text[i] == '\0') break;
+        start = i + 1;
+    }
+
+    if (t->width > 0 && layout->block_width < t->width) layout->block_width = t->width;
+    layout->block_height =
+        text_block_height((int)arrlen(layout->lines), layout->line_height, layout->font, layout->font_size);
+}
+
+// The text shown by a text instance: its raw-text children joined. A single child's string is
+// shared rather than copied.
+static char *text_layout_source(const ReactInstance *text)
+{
+    char *single = NULL;
+    int parts = 0;
+    size_t total = 0;
+    int count = arrlen(text->children);
+    for (int i = 0; i < count; i++) {
+        ReactInstance *child = text->children[i];
+        if (!child || child->type != NT_RAW_TEXT || !child->props.raw_text) continue;
+        single = child->props.raw_text;
+        total += strlen(single);
+        parts++;
+    }
+    if (parts == 0) return NULL;
+    if (parts == 1) return instance_string_retain(single);
+
+    char *joined = NULL;
+    arrsetcap(joined, total + 1);
+    for (int i = 0; i < count; i++) {
+        ReactInstance *child = text->children[i];
+        if (!child || child->type != NT_RAW_TEXT || !child->props.raw_text) continue;
+        size_t len = strlen(child->props.raw_text);
+        memcpy(arraddnptr(joined, len), child->props.raw_text, len);
+    }
+    arrput(joined, '\0');
+    char *source = instance_string_new(joined);
+    arrfree(joined);
+    return source;
+}
+
+TextLayout *text_layout_create(const ReactInstance *text)
+{
+    TextLayout *layout = calloc(1, sizeof(TextLayout));
+    if (!layout) return NULL;
+
+    const TextProps *t = &text->props.text;
+    layout->refcount = 1;
+    layout->font = font_registry_get(t->font_name);
+    layout->font_size = t->font_size > 0 ? t->font_size : 30;
+    layout->line_height = text_line_height(t);
+    layout->width = t->width;
+    layout->wrap = t->wrap;
+    layout->line_height_prop = t->line_height;
+    layout->text = text_layout_source(text);
+
+    text_layout_build(layout, t);
+    return layout;
+}
+
+// Whether the raw-text children of text join to source, without joining them.
+static bool text_layout_same_source(const char *source, const ReactInstance *text)
+{
+    size_t offset = 0;
+    bool any = false;
+    int count = arrlen(text->children);
+    for (int i = 0; i < count; i++) {
+        ReactInstance *child = text->children[i];
+        if (!child || child->type != NT_RAW_TEXT || !child->props.raw_text) continue;
+        const char *part = child->props.raw_text;
+        any = true;
+        if (!source) return false;
+        if (part == source && offset == 0) {
+            offset = strlen(part);
+            continue;
+        }
+        size_t len = strlen(part);
+        if (strncmp(source + offset, part, len) != 0) return false;
+        offset += len;
+    }
+    return any ? source[offset] == '\0' : source == NULL;
+}
+
+bool text_layout_matches(const TextLayout *layout, const ReactInstance *text)
+{
+    if (!layout) return false;
+    const TextProps *t = &text->props.text;
+    Font font = font_registry_get(t->font_name);
+    int font_size = t->font_size > 0 ? t->font_size : 30;
+    if (font.texture.id != layout->font.texture.id || font.glyphs != layout->font.glyphs ||
+        font.baseSize != layout->font.baseSize) {
+        return false;
+    }
+    if (font_size != layout->font_size || t->width != layout->width || t->wrap != layout->wrap ||
+        t->line_height != layout->line_height_prop) {
+        return false;
+    }
+    return text_layout_same_source(layout->text, text);
+}
+
+TextLayout *text_layout_retain(TextLayout *layout)
+{
+    if (layout) layout->refcount++;
+    return layout;
+}
+
+bool text_layout_release(TextLayout *layout)
+{
+    if (!layout || --layout->refcount > 0) return false;
+    instance_string_release(layout->text);
+    arrfree(layout->lines);
+    free(layout);
+    return true;
+}
+
+size_t text_layout_bytes(const TextLayout *layout)
+{
+    if (!layout) return 0;
+    return sizeof(TextLayout) + arrcap(layout->lines) * sizeof(TextLine);
+}
+
+void text_layout_draw_line(const TextLayout *layout, int index, Vector2 position, Color tint)
+{
+    const TextLine *line = &layout->lines[index];
+    if (line->length == 0) return;
+    const char *text = layout->text + line->start;
+    Font font = layout->font;
+    if (font.texture.id == 0) font = GetFontDefault();
+    float scale = (float)layout->font_size / (float)font.baseSize;
+
+    // DrawTextEx without the terminator: the line is a span of the shared source string.
+    float offset_x = 0.0f;
+    for (int i = 0; i < line->length;) {
+        int bytes = 0;
+        int codepoint = GetCodepointNext(&text[i], &bytes);
+        int glyph = GetGlyphIndex(font, codepoint);
+        if (codepoint != ' ' && codepoint != '\t') {
+            DrawTextCodepoint(font, codepoint, (Vector2){position.x + offset_x, position.y}, (float)layout->font_size,
+                              tint);
+        }
+        float advance = font.glyphs[glyph].advanceX > 0 ? (float)font.glyphs[glyph].advanceX : font.recs[glyph].width;
+        offset_x += advance * scale + TEXT_SPACING;
+        i += bytes > 0 ? bytes : 1;
+    }
+}
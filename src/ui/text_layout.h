@@ -0,0 +1,45 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <raylib.h>
+#include "instance_tree.h"
+
+/* One laid-out line: a byte span of the layout's source text and its measured width. */
+typedef struct {
+    int start;
+    int length;
+    int width;
+} TextLine;
+
+/* Wrapped and measured lines of a text instance. Built on the JS thread at swap time and
+ * read by the renderer. Snapshot copies whose text and metrics inputs did not change share
+ * the previous copy's layout; refcounts follow the snapshot copies' threading rules. */
+struct TextLayout {
+    char *text; /* shared instance string; NULL when there are no raw-text children */
+    TextLine *lines; /* stb_ds array, never empty */
+    Font font;
+    int font_size;
+    int line_height;
+    int block_width;
+    int block_height;
+    /* Inputs besides text and font that the lines depend on. */
+    int width;
+    TextWrap wrap;
+    int line_height_prop;
+    int refcount;
+};
+
+/* Lay out the raw-text children of a text instance. Returns NULL on allocation failure. */
+TextLayout *text_layout_create(const ReactInstance *text);
+/* Whether layout is what text_layout_create would build for text (false for NULL). */
+bool text_layout_matches(const TextLayout *layout, const ReactInstance *text);
+TextLayout *text_layout_retain(TextLayout *layout);
+/* Drop one reference; returns true when this freed the layout. */
+bool text_layout_release(TextLayout *layout);
+// Heap owned by the layout, excluding its shared source string (0 for NULL).
+size_t text_layout_bytes(const TextLayout *layout);
+
+/* Draw line `index` with its top-left corner at position. */
+void text_layout_draw_line(const TextLayout *layout, int index, Vector2 position, Color tint);
+
+#endif /* TEXT_LAYOUT_H */
@@ -9,6 +9,7 @@
 #include <sys/socket.h>
 #include <unistd.h>
 #include "arena.h"
+#include "core/profiler.h"
 #include "upload/archive.h"
 
 #ifdef __vita__
@@ -389,6 +390,7 @@ done:
 static void *handler_thread(void *raw)
 {
     HandlerArg *arg = raw;
+    double zone = prof_begin();
     char first[1024];
     ssize_t n = recv(arg->fd, first, sizeof(first) - 1, MSG_PEEK);
     if (n <= 0) goto done;
@@ -420,6 +422,7 @@ static void *handler_thread(void *raw)
     }
 
 done:
+    prof_end_lane(PROF_THREAD_UPLOAD, arg->fd, "request", zone);
     remove_client_fd(arg->server, arg->fd);
     close(arg->fd);
     free(arg);
@@ -0,0 +1,196 @@
+#include <raylib.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STB_DS_IMPLEMENTATION
+#include "stb_ds.h"
+#include "core/bootstrap.h"
+#include "core/js_runtime.h"
+#include "core/package_library.h"
+#include "jslib/jslib.h"
+#include "ui/instance_tree.h"
+
+// Drives the bench Deck App (js/examples/bench) and reports reconciler and swap throughput per
+// scenario. The app logs "BENCH begin/end/done" lines; the log callback runs on the JS thread
+// at those points, so the counters sampled there bracket each scenario exactly.
+
+#define RUN_TIMEOUT_SEC 120.0
+#define MAX_SCENARIOS 16
+
+typedef struct {
+    char name[32];
+    int steps;
+    double seconds;
+    InstanceTreeStats tree;
+    MutationStats mutations;
+} BenchResult;
+
+typedef struct {
+    double time;
+    InstanceTreeStats tree;
+    MutationStats mutations;
+} BenchSample;
+
+static BenchResult results[MAX_SCENARIOS];
+static int result_count = 0;
+static BenchSample scenario_start;
+static atomic_bool run_done;
+static atomic_bool run_failed;
+
+static void fail(const char *message)
+{
+    fprintf(stderr, "bench_harness: %s\n", message);
+    exit(1);
+}
+
+static BenchSample take_sample(void)
+{
+    BenchSample sample = {.time = GetTime()};
+    instance_tree_get_stats(&sample.tree);
+    get_mutation_stats(&sample.mutations);
+    return sample;
+}
+
+static void finish_scenario(const char *name, int steps)
+{
+    if (result_count >= MAX_SCENARIOS) return;
+    BenchSample end = take_sample();
+    BenchResult *r = &results[result_count++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->steps = steps;
+    r->seconds = end.time - scenario_start.time;
+    r->tree.commits = end.tree.commits - scenario_start.tree.commits;
+    r->tree.swaps = end.tree.swaps - scenario_start.tree.swaps;
+    r->tree.swap_seconds = end.tree.swap_seconds - scenario_start.tree.swap_seconds;
+    r->tree.snapshot_copies = end.tree.snapshot_copies - scenario_start.tree.snapshot_copies;
+    r->tree.snapshot_nodes = end.tree.snapshot_nodes;
+    r->tree.snapshot_bytes = end.tree.snapshot_bytes;
+    r->mutations.batches = end.mutations.batches - scenario_start.mutations.batches;
+    r->mutations.ops = end.mutations.ops - scenario_start.mutations.ops;
+}
+
+static void handle_bench_line(const char *line)
+{
+    char name[32] = {0};
+    int steps = 0;
+    if (sscanf(line, "BENCH begin %31s", name) == 1) {
+        scenario_start = take_sample();
+    } else if (sscanf(line, "BENCH end %31s %d", name, &steps) == 2) {
+        finish_scenario(name, steps);
+    } else if (strcmp(line, "BENCH done") == 0) {
+        atomic_store(&run_done, true);
+    } else {
+        fprintf(stderr, "bench_harness: unexpected line: %s\n", line);
+        atomic_store(&run_failed, true);
+    }
+}
+
+static void bench_log(int level, const char *text, va_list args)
+{
+    char line[1024];
+    vsnprintf(line, sizeof(line), text, args);
+    if (strncmp(line, "BENCH ", 6) == 0) {
+        handle_bench_line(line);
+    } else if (level >= LOG_WARNING) {
+        fprintf(stderr, "%s\n", line);
+    }
+}
+
+static double per_second(unsigned long count, double seconds)
+{
+    return seconds > 0.0 ? (double)count / seconds : 0.0;
+}
+
+static void print_results(void)
+{
+    printf("%-10s %6s %9s %10s %10s %11s %9s %8s %11s %9s %10s\n", "scenario", "steps", "ms/step", "commits/s",
+           "batches/s", "ops/s", "swaps/s", "swap ms", "copies/swap", "nodes", "snap KiB");
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult *r = &results[i];
+        double swap_ms = r->tree.swaps > 0 ? r->tree.swap_seconds * 1000.0 / (double)r->tree.swaps : 0.0;
+        double copies = r->tree.swaps > 0 ? (double)r->tree.snapshot_copies / (double)r->tree.swaps : 0.0;
+        printf("%-10s %6d %9.3f %10.1f %10.1f %11.1f %9.1f %8.3f %11.1f %9ld %10.1f\n", r->name, r->steps,
+               r->steps > 0 ? r->seconds * 1000.0 / r->steps : 0.0, per_second(r->tree.commits, r->seconds),
+               per_second(r->mutations.batches, r->seconds), per_second(r->mutations.ops, r->seconds),
+               per_second(r->tree.swaps, r->seconds), swap_ms, copies, r->tree.snapshot_nodes,
+               (double)r->tree.snapshot_bytes / 1024.0);
+    }
+}
+
+static void write_metric(FILE *f, bool *first, const char *scenario, const char *metric, double value)
+{
+    fprintf(f, "%s\n  \"reconciler.%s.%s\": %.4f", *first ? "" : ",", scenario, metric, value);
+    *first = false;
+}
+
+// Flat {"reconciler.<scenario>.<metric>": value} object read by tests/perf_gate.mjs. Every metric
+// is lower-is-better; counts are per step or per swap so they do not depend on run length.
+static bool write_json(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    bool first = true;
+    fputs("{", f);
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult *r = &results[i];
+        double steps = r->steps > 0 ? (double)r->steps : 1.0;
+        double swaps = r->tree.swaps > 0 ? (double)r->tree.swaps : 1.0;
+        write_metric(f, &first, r->name, "ms_per_step", r->seconds * 1000.0 / steps);
+        write_metric(f, &first, r->name, "swap_ms", r->tree.swap_seconds * 1000.0 / swaps);
+        write_metric(f, &first, r->name, "ops_per_step", (double)r->mutations.ops / steps);
+        write_metric(f, &first, r->name, "copies_per_swap", (double)r->tree.snapshot_copies / swaps);
+        write_metric(f, &first, r->name, "snapshot_bytes", (double)r->tree.snapshot_bytes);
+    }
+    fputs("\n}\n", f);
+    return fclose(f) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *json_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--json PATH]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    atomic_init(&run_done, false);
+    atomic_init(&run_failed, false);
+    SetTraceLogCallback(bench_log);
+    SetTraceLogLevel(LOG_INFO);
+
+    VdBootstrap bootstrap;
+    // Text layout at swap time needs the default font's glyph metrics, which only load with a GL
+    // context: keep the window hidden. This test is labelled gl (docs/adr/0002-smoke-ci-linux-xvfb.md).
+    VdBootstrapWindowConfig window_config = {.raylib_config_flags = FLAG_WINDOW_HIDDEN};
+    bootstrap_init(&bootstrap);
+
+    char init_error[256];
+    if (!bootstrap_boot_subsystems(init_error, sizeof(init_error))) fail(init_error);
+    if (!package_library_has_active_deck_app()) fail("no active deck app configured");
+    if (!bootstrap_open_window(&bootstrap, "VitaDeck Bench", &window_config, init_error, sizeof(init_error))) {
+        fail(init_error);
+    }
+    if (!bootstrap_start_active_deck_app(&bootstrap, init_error, sizeof(init_error))) fail(init_error);
+
+    double deadline = GetTime() + RUN_TIMEOUT_SEC;
+    while (!atomic_load(&run_done)) {
+        if (js_runtime_failed(&bootstrap.js_runtime)) fail("JS runtime failed");
+        if (atomic_load(&run_failed)) fail("bench app reported an unexpected line");
+        if (GetTime() > deadline) fail("timed out waiting for BENCH done");
+        WaitTime(0.01);
+    }
+
+    bootstrap_shutdown(&bootstrap);
+    if (result_count == 0) fail("no scenarios ran");
+    print_results();
+    if (json_path && !write_json(json_path)) fail("could not write the JSON results");
+    return 0;
+}
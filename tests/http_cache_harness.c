@@ -0,0 +1,149 @@
+#define STB_DS_IMPLEMENTATION
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "jslib/http_cache.h"
+#include "stb_ds.h"
+
+#define CACHE_BUDGET 4096
+
+static const char *const URL_FRESH = "https://example.test/config.json";
+static const char *const URL_ETAG = "https://example.test/icon.png";
+static const char *const URL_NO_STORE = "https://example.test/private";
+static const char *const URL_VARY = "https://example.test/localized";
+static const char *const URL_COOKIE = "https://example.test/feed.json";
+
+static char cache_dir[] = "/tmp/vitadeck-http-cache-XXXXXX";
+
+static void expect(bool ok, const char *message)
+{
+    if (ok) return;
+    fprintf(stderr, "http_cache_harness: %s\n", message);
+    exit(1);
+}
+
+static bool store(const char *url, time_t now, const char *headers, const char *body)
+{
+    return http_cache_store(url, now, "HTTP/1.1 200 OK", headers, strlen(headers), body, strlen(body));
+}
+
+static void expect_body(const char *url, const char *body)
+{
+    HttpCacheResponse response;
+    expect(http_cache_load(url, &response), "stored response could not be loaded");
+    bool same = response.status == 200 && response.body_size == strlen(body) &&
+                memcmp(response.body, body, response.body_size) == 0 &&
+                strcmp(response.status_line, "HTTP/1.1 200 OK") == 0 && strstr(response.headers, "Content-Type:");
+    http_cache_response_free(&response);
+    expect(same, "loaded response differs from the stored one");
+}
+
+int main(void)
+{
+    SetTraceLogLevel(LOG_WARNING);
+    expect(mkdtemp(cache_dir) != NULL, "could not create a temporary directory");
+    expect(http_cache_open(cache_dir, CACHE_BUDGET), "could not open the cache");
+
+    time_t now = 1700000000;
+    HttpCacheValidators validators;
+
+    // max-age: fresh until it runs out, then a miss because there is nothing to revalidate with.
+    expect(store(URL_FRESH, now, "Content-Type: application/json\r\nCache-Control: public, max-age=60\r\n",
+                 "{\"theme\":\"dark\"}"),
+           "max-age response was not stored");
+    expect(http_cache_lookup(URL_FRESH, now + 59, &validators) == HTTP_CACHE_FRESH, "max-age entry is not fresh");
+    expect(http_cache_lookup(URL_FRESH, now + 61, &validators) == HTTP_CACHE_MISS, "expired entry without validators");
+    expect_body(URL_FRESH, "{\"theme\":\"dark\"}");
+
+    // Age counts against max-age.
+    expect(store(URL_FRESH, now, "Content-Type: application/json\r\nCache-Control: max-age=60\r\nAge: 50\r\n", "{}"),
+           "aged response was not stored");
+    expect(http_cache_lookup(URL_FRESH, now + 11, &validators) == HTTP_CACHE_MISS, "Age was not subtracted");
+
+    // Validators only: stored, always revalidated, refreshed by a 304.
+    const char *etag_headers =
+        "Content-Type: image/png\r\nETag: \"v1\"\r\nLast-Modified: Tue, 14 Nov 2023 22:13:20 GMT\r\n";
+    expect(store(URL_ETAG, now, etag_headers, "PNGDATA"), "ETag response was not stored");
+    expect(http_cache_lookup(URL_ETAG, now, &validators) == HTTP_CACHE_STALE, "ETag entry is not stale");
+    expect(strcmp(validators.etag, "\"v1\"") == 0, "wrong ETag validator");
+    expect(strcmp(validators.last_modified, "Tue, 14 Nov 2023 22:13:20 GMT") == 0, "wrong Last-Modified validator");
+    const char *not_modified = "ETag: \"v1\"\r\nCache-Control: max-age=30\r\n";
+    http_cache_refresh(URL_ETAG, now + 100, not_modified, strlen(not_modified));
+    expect(http_cache_lookup(URL_ETAG, now + 120, &validators) == HTTP_CACHE_FRESH, "304 did not refresh the entry");
+    expect_body(URL_ETAG, "PNGDATA");
+
+    // Expires relative to Date.
+    expect(store(URL_FRESH, now,
+                 "Content-Type: text/plain\r\nDate: Tue, 14 Nov 2023 22:13:20 GMT\r\n"
+                 "Expires: Tue, 14 Nov 2023 22:14:20 GMT\r\n",
+                 "expires"),
+           "Expires response was not stored");
+    expect(http_cache_lookup(URL_FRESH, now + 30, &validators) == HTTP_CACHE_FRESH, "Expires entry is not fresh");
+    expect(http_cache_lookup(URL_FRESH, now + 90, &validators) == HTTP_CACHE_MISS, "Expires entry did not expire");
+
+    // no-store responses are never stored.
+    expect(!store(URL_NO_STORE, now, "Content-Type: text/plain\r\nCache-Control: no-store\r\n", "secret"),
+           "no-store response was stored");
+    expect(http_cache_lookup(URL_NO_STORE, now, &validators) == HTTP_CACHE_MISS, "no-store response is cached");
+
+    // private responses are never stored: the cache is shared by every Deck App.
+    expect(!store(URL_NO_STORE, now, "Content-Type: text/plain\r\nCache-Control: private, max-age=60\r\n", "secret"),
+           "private response was stored");
+    expect(http_cache_lookup(URL_NO_STORE, now, &validators) == HTTP_CACHE_MISS, "private response is cached");
+
+    // Responses that vary on request headers are never stored: entries are keyed by URL only.
+    expect(!store(URL_VARY, now, "Content-Type: text/plain\r\nCache-Control: max-age=60\r\nVary: Accept-Language\r\n",
+                  "bonjour"),
+           "Vary response was stored");
+    expect(http_cache_lookup(URL_VARY, now, &validators) == HTTP_CACHE_MISS, "Vary response is cached");
+
+    // Set-Cookie and the hop-by-hop headers are not replayed from the shared cache.
+    expect(store(URL_COOKIE, now,
+                 "Content-Type: application/json\r\nCache-Control: max-age=60\r\nSet-Cookie: session=abc\r\n"
+                 "Connection: close, X-Hop\r\nX-Hop: 1\r\nTransfer-Encoding: chunked\r\nX-Kept: 1\r\n",
+                 "[]"),
+           "response with cookies was not stored");
+    HttpCacheResponse replay;
+    expect(http_cache_load(URL_COOKIE, &replay), "response with cookies could not be loaded");
+    bool stripped = !strstr(replay.headers, "Set-Cookie") && !strstr(replay.headers, "Connection") &&
+                    !strstr(replay.headers, "X-Hop") && !strstr(replay.headers, "Transfer-Encoding") &&
+                    strstr(replay.headers, "Content-Type:") && strstr(replay.headers, "X-Kept: 1\r\n");
+    http_cache_response_free(&replay);
+    expect(stripped, "stored headers keep Set-Cookie or hop-by-hop headers");
+
+    // The index survives a reopen.
+    http_cache_close();
+    expect(http_cache_open(cache_dir, CACHE_BUDGET), "could not reopen the cache");
+    expect(http_cache_lookup(URL_ETAG, now + 120, &validators) == HTTP_CACHE_FRESH, "entry lost on reopen");
+    expect_body(URL_ETAG, "PNGDATA");
+
+    // The budget evicts least recently used entries; oversized bodies are not stored.
+    char body[CACHE_BUDGET / 4];
+    memset(body, 'x', sizeof(body) - 1);
+    body[sizeof(body) - 1] = '\0';
+    char url[64];
+    for (int i = 0; i < 8; i++) {
+        snprintf(url, sizeof(url), "https://example.test/blob/%d", i);
+        expect(store(url, now + 200 + i, "Content-Type: text/plain\r\nCache-Control: max-age=600\r\n", body),
+               "blob was not stored");
+    }
+    expect(http_cache_size() <= CACHE_BUDGET, "cache exceeds its budget");
+    expect(http_cache_lookup("https://example.test/blob/0", now + 300, NULL) == HTTP_CACHE_MISS,
+           "least recently used blob was not evicted");
+    expect(http_cache_lookup("https://example.test/blob/7", now + 300, NULL) == HTTP_CACHE_FRESH,
+           "newest blob was evicted");
+    char big[CACHE_BUDGET / 2];
+    memset(big, 'y', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    expect(!store("https://example.test/big", now, "Content-Type: text/plain\r\nCache-Control: max-age=600\r\n", big),
+           "oversized body was stored");
+
+    http_cache_close();
+    char command[128];
+    snprintf(command, sizeof(command), "rm -rf %s", cache_dir);
+    expect(system(command) == 0, "could not remove the temporary directory");
+    return 0;
+}
@@ -0,0 +1,117 @@
+#!/usr/bin/env node
+// Merges the flat JSON results written by the bench harnesses (--json) and compares them with a
+// checked-in baseline. Every metric is lower-is-better; a metric regresses when
+//   current > baseline * (1 + relative) + absolute
+// with relative/absolute taken from the first matching pattern in the tolerances file, both
+// multiplied by VITADECK_PERF_TOLERANCE_SCALE (default 1) for noisy machines. Patterns marked
+// "report" (wall-clock timings, too noisy on shared runners) are printed but never fail the gate.
+//
+// usage: perf_gate.mjs --baseline PATH --tolerances PATH --output PATH [--update-baseline] RESULTS...
+import { existsSync, readFileSync, writeFileSync } from "node:fs";
+
+function fail(message) {
+  console.error(`perf_gate: ${message}`);
+  process.exit(2);
+}
+
+function parseArgs(argv) {
+  const args = { inputs: [], updateBaseline: false };
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === "--baseline" || arg === "--tolerances" || arg === "--output") {
+      if (i + 1 >= argv.length) fail(`${arg} requires a path`);
+      args[arg.slice(2)] = argv[++i];
+    } else if (arg === "--update-baseline") {
+      args.updateBaseline = true;
+    } else {
+      args.inputs.push(arg);
+    }
+  }
+  if (!args.baseline || !args.tolerances || !args.output || args.inputs.length === 0) {
+    fail("usage: perf_gate.mjs --baseline PATH --tolerances PATH --output PATH [--update-baseline] RESULTS...");
+  }
+  return args;
+}
+
+function readJson(path) {
+  try {
+    return JSON.parse(readFileSync(path, "utf8"));
+  } catch (error) {
+    fail(`could not read ${path}: ${error.message}`);
+  }
+}
+
+function writeMetrics(path, metrics) {
+  const sorted = {};
+  for (const key of Object.keys(metrics).sort()) sorted[key] = metrics[key];
+  writeFileSync(path, `${JSON.stringify(sorted, null, 2)}\n`);
+}
+
+function globToRegExp(pattern) {
+  const escaped = pattern.replace(/[.+?^${}()|[\]\\]/g, "\\$&").replace(/\*/g, "[^]*");
+  return new RegExp(`^${escaped}$`);
+}
+
+function toleranceRules(config) {
+  const rules = Object.entries(config.metrics ?? {}).map(([pattern, tolerance]) => ({
+    match: globToRegExp(pattern),
+    tolerance,
+  }));
+  const fallback = config.default ?? { report: true };
+  return (key) => rules.find((rule) => rule.match.test(key))?.tolerance ?? fallback;
+}
+
+const args = parseArgs(process.argv.slice(2));
+
+const results = {};
+for (const input of args.inputs) {
+  for (const [key, value] of Object.entries(readJson(input))) {
+    if (typeof value !== "number" || !Number.isFinite(value)) fail(`${input}: ${key} is not a number`);
+    results[key] = value;
+  }
+}
+writeMetrics(args.output, results);
+
+// A missing baseline is bootstrapped locally, but CI starts from a fresh checkout every time and
+// would never compare against anything.
+if (!args.updateBaseline && !existsSync(args.baseline) && process.env.CI) {
+  fail(`no baseline at ${args.baseline}; commit the ${args.output} produced by this run as the baseline`);
+}
+
+if (args.updateBaseline || !existsSync(args.baseline)) {
+  writeMetrics(args.baseline, results);
+  console.log(`perf_gate: wrote baseline ${args.baseline} (${Object.keys(results).length} metrics)`);
+  process.exit(0);
+}
+
+const baseline = readJson(args.baseline);
+const toleranceFor = toleranceRules(readJson(args.tolerances));
+const scale = Number(process.env.VITADECK_PERF_TOLERANCE_SCALE ?? "1");
+if (!Number.isFinite(scale) || scale < 0) fail("VITADECK_PERF_TOLERANCE_SCALE must be a non-negative number");
+
+let regressions = 0;
+for (const key of Object.keys(baseline).sort()) {
+  const expected = baseline[key];
+  const actual = results[key];
+  if (actual === undefined) {
+    console.log(`MISSING  ${key} (baseline ${expected})`);
+    regressions++;
+    continue;
+  }
+  const { relative = 0, absolute = 0, report = false } = toleranceFor(key);
+  const limit = expected * (1 + relative * scale) + absolute * scale;
+  const change = expected !== 0 ? `${(((actual - expected) / expected) * 100).toFixed(1)}%` : "n/a";
+  const status = actual <= limit ? "ok" : report ? "SLOWER" : "REGRESS";
+  if (status === "REGRESS") regressions++;
+  const detail = `baseline=${expected} current=${actual} (${change}, limit ${limit.toFixed(4)})`;
+  console.log(`${status.padEnd(8)} ${key} ${detail}`);
+}
+for (const key of Object.keys(results)) {
+  if (!(key in baseline)) console.log(`NEW      ${key} current=${results[key]} (not in baseline)`);
+}
+
+if (regressions > 0) {
+  console.error(`perf_gate: ${regressions} metric(s) regressed against ${args.baseline}`);
+  process.exit(1);
+}
+console.log(`perf_gate: ok (no gated metric regressed against ${args.baseline})`);
@@ -0,0 +1,295 @@
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STB_DS_IMPLEMENTATION
+#include "stb_ds.h"
+#include "core/bootstrap.h"
+#include "core/package_library.h"
+#include "ui/images.h"
+#include "ui/instance_tree.h"
+#include "ui/render.h"
+
+// Builds synthetic scenes straight through the instance_back_* API (no JS runtime) and renders
+// each one into a RenderTexture repeatedly. Every scene is dominated by one node type, so its
+// time per node approximates that type's cost in render_draw_list. Times cover CPU-side drawing
+// and the batch flush at EndTextureMode, not GPU completion.
+
+#define WARMUP_FRAMES 20
+#define MEASURED_FRAMES 240
+#define BENCH_IMAGE_NAME "benchChecker"
+
+typedef struct {
+    const char *name;
+    NodeType type; // node type the per-node cost is attributed to
+    void (*build)(void);
+} RenderScene;
+
+static InstanceHandle next_handle = 1;
+
+static const Color SURFACE = {27, 38, 59, 255};
+static const Color SURFACE_ALT = {65, 90, 119, 255};
+static const Color OUTLINE = {119, 141, 169, 255};
+static const Color TEXT_COLOR = {224, 225, 221, 255};
+static const Color ACCENT = {233, 196, 106, 255};
+
+static void fail(const char *message)
+{
+    fprintf(stderr, "render_bench_harness: %s\n", message);
+    exit(1);
+}
+
+static ReactInstance *add_node(ReactInstance *parent, NodeType type)
+{
+    ReactInstance *inst = calloc(1, sizeof(ReactInstance));
+    if (!inst) fail("out of memory");
+    inst->id = next_handle++;
+    inst->type = type;
+    instance_back_put(inst);
+    if (parent) {
+        instance_back_append_child(parent, inst);
+    } else {
+        instance_back_root_append(inst);
+    }
+    return inst;
+}
+
+static ReactInstance *add_rect(ReactInstance *parent, int x, int y, int width, int height, int variant)
+{
+    ReactInstance *rect = add_node(parent, NT_RECT);
+    rect->props.rect = (RectProps){
+        .x = x,
+        .y = y,
+        .width = width,
+        .height = height,
+        .has_fill = variant != 2,
+        .has_outline = variant == 2,
+        .fill_color = variant == 0 ? SURFACE : SURFACE_ALT,
+        .border_color = OUTLINE,
+        .border_radius = variant == 1 ? 6.0f : 0.0f,
+    };
+    return rect;
+}
+
+static void build_rects(void)
+{
+    for (int i = 0; i < 2000; i++) {
+        add_rect(NULL, (i * 37) % (VD_SCREEN_WIDTH - 60), (i * 23) % (VD_SCREEN_HEIGHT - 40), 60, 40, i % 3);
+    }
+}
+
+static void build_text(void)
+{
+    static const char *body = "Wrapped text blocks measure glyph drawing for the default font across several "
+                              "lines, the common case for descriptions and chat messages.";
+    for (int i = 0; i < 120; i++) {
+        ReactInstance *text = add_node(NULL, NT_TEXT);
+        text->props.text = (TextProps){
+            .font_size = 16,
+            .has_color = true,
+            .color = TEXT_COLOR,
+            .x = (i % 4) * 235,
+            .y = (i / 4 % 6) * 88,
+            .width = 220,
+            .wrap = TEXT_WRAP_WORD,
+        };
+        ReactInstance *raw = add_node(text, NT_RAW_TEXT);
+        raw->props.raw_text = instance_string_new(body);
+    }
+}
+
+static void build_buttons(void)
+{
+    for (int i = 0; i < 400; i++) {
+        ReactInstance *button = add_node(NULL, NT_BUTTON);
+        button->props.button = (ButtonProps){
+            .x = (i % 8) * 118,
+            .y = (i / 8 % 14) * 38,
+            .width = 112,
+            .height = 32,
+            .color = ACCENT,
+            .text_color = SURFACE,
+            .label = instance_string_new("Button"),
+            .font_size = 16,
+            .border_radius = 12.0f,
+        };
+    }
+}
+
+static ReactInstance *add_scroll(ReactInstance *parent, int x, int y, int width, int height)
+{
+    ReactInstance *scroll = add_node(parent, NT_SCROLL);
+    scroll->props.scroll = (ScrollProps){
+        .x = x,
+        .y = y,
+        .width = width,
+        .height = height,
+        .has_fill = true,
+        .fill_color = SURFACE,
+        .gap = 4,
+        .padding = 6,
+    };
+    return scroll;
+}
+
+// 8 outer scrolls, each with 8 inner scrolls of 10 rects.
+static void build_scrolls(void)
+{
+    for (int i = 0; i < 8; i++) {
+        ReactInstance *outer = add_scroll(NULL, (i % 4) * 238, (i / 4) * 270, 230, 260);
+        for (int j = 0; j < 8; j++) {
+            ReactInstance *inner = add_rect(outer, 0, 0, 210, 120, 0);
+            ReactInstance *scroll = add_scroll(inner, 4, 4, 200, 110);
+            for (int k = 0; k < 10; k++) {
+                add_rect(scroll, 0, 0, 180, 20, k % 3);
+            }
+        }
+    }
+}
+
+static void build_images(void)
+{
+    for (int i = 0; i < 1000; i++) {
+        ReactInstance *image = add_node(NULL, NT_IMAGE);
+        image->props.image = (ImageProps){
+            .image_name = instance_string_new(BENCH_IMAGE_NAME),
+            .x = (i * 41) % (VD_SCREEN_WIDTH - 48),
+            .y = (i * 29) % (VD_SCREEN_HEIGHT - 48),
+            .width = 48,
+            .height = 48,
+        };
+    }
+}
+
+static const RenderScene scenes[] = {
+    {"rects", NT_RECT, build_rects},       {"text", NT_TEXT, build_text},
+    {"buttons", NT_BUTTON, build_buttons}, {"scrolls", NT_SCROLL, build_scrolls},
+    {"images", NT_IMAGE, build_images},
+};
+
+// A generated checkerboard registered as an image package under the data root.
+static void load_bench_image(void)
+{
+    char dir[VD_PATH_MAX];
+    char path[VD_PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s/render-bench", package_library_root());
+    MakeDirectory(dir);
+
+    snprintf(path, sizeof(path), "%s/checker.png", dir);
+    Image checker = GenImageChecked(64, 64, 8, 8, ACCENT, SURFACE_ALT);
+    bool exported = ExportImage(checker, path);
+    UnloadImage(checker);
+    if (!exported) fail("could not write the bench image");
+
+    snprintf(path, sizeof(path), "%s/manifest.json", dir);
+    FILE *f = fopen(path, "w");
+    if (!f) fail("could not write the bench image manifest");
+    fprintf(f, "{\"images\": {\"%s\": \"checker.png\"}}\n", BENCH_IMAGE_NAME);
+    fclose(f);
+
+    char error[256];
+    if (!image_registry_load_package(dir, error, sizeof(error))) fail(error);
+}
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+typedef struct {
+    const char *name;
+    double mean_ms;
+    double p95_ms;
+} SceneResult;
+
+static SceneResult scene_results[sizeof(scenes) / sizeof(scenes[0])];
+
+static SceneResult run_scene(const RenderScene *scene, RenderTexture2D target)
+{
+    instance_tree_clear();
+    scene->build();
+    instance_tree_commit();
+    instance_tree_swap();
+    int nodes = instance_tree_count_nodes(scene->type);
+
+    double frames[MEASURED_FRAMES];
+    for (int i = 0; i < WARMUP_FRAMES + MEASURED_FRAMES; i++) {
+        double start = GetTime();
+        BeginTextureMode(target);
+        ClearBackground(BLACK);
+        render_draw_list();
+        EndTextureMode();
+        if (i >= WARMUP_FRAMES) frames[i - WARMUP_FRAMES] = GetTime() - start;
+    }
+
+    double total = 0.0;
+    for (int i = 0; i < MEASURED_FRAMES; i++) {
+        total += frames[i];
+    }
+    qsort(frames, MEASURED_FRAMES, sizeof(double), compare_doubles);
+    double mean_ms = total * 1000.0 / MEASURED_FRAMES;
+    double p50_ms = frames[MEASURED_FRAMES / 2] * 1000.0;
+    double p95_ms = frames[MEASURED_FRAMES * 95 / 100] * 1000.0;
+    double per_node_us = nodes > 0 ? mean_ms * 1000.0 / nodes : 0.0;
+    printf("%-10s %7d %9.3f %9.3f %9.3f %10.3f\n", scene->name, nodes, mean_ms, p50_ms, p95_ms, per_node_us);
+    return (SceneResult){scene->name, mean_ms, p95_ms};
+}
+
+// Flat {"render.<scene>.<metric>": value} object read by tests/perf_gate.mjs (lower is better).
+static bool write_json(const char *path, const SceneResult *results, int count)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fputs("{", f);
+    for (int i = 0; i < count; i++) {
+        fprintf(f, "%s\n  \"render.%s.mean_ms\": %.4f,", i > 0 ? "," : "", results[i].name, results[i].mean_ms);
+        fprintf(f, "\n  \"render.%s.p95_ms\": %.4f", results[i].name, results[i].p95_ms);
+    }
+    fputs("\n}\n", f);
+    return fclose(f) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *json_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--json PATH]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    VdBootstrap bootstrap;
+    VdBootstrapWindowConfig window_config = {.raylib_config_flags = FLAG_WINDOW_HIDDEN};
+    bootstrap_init(&bootstrap);
+
+    char init_error[256];
+    if (!bootstrap_boot_subsystems(init_error, sizeof(init_error))) fail(init_error);
+    if (!bootstrap_open_window(&bootstrap, "VitaDeck Render Bench", &window_config, init_error, sizeof(init_error))) {
+        fail(init_error);
+    }
+    load_bench_image();
+
+    RenderTexture2D target = LoadRenderTexture(VD_SCREEN_WIDTH, VD_SCREEN_HEIGHT);
+    if (!IsRenderTextureValid(target)) fail("could not create the render texture");
+
+    printf("%-10s %7s %9s %9s %9s %10s\n", "scene", "nodes", "mean ms", "p50 ms", "p95 ms", "us/node");
+    int scene_count = (int)(sizeof(scenes) / sizeof(scenes[0]));
+    for (int i = 0; i < scene_count; i++) {
+        scene_results[i] = run_scene(&scenes[i], target);
+    }
+
+    instance_tree_clear();
+    UnloadRenderTexture(target);
+    bootstrap_shutdown(&bootstrap);
+    if (json_path && !write_json(json_path, scene_results, scene_count)) fail("could not write the JSON results");
+    return 0;
+}
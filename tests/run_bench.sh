@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+BUILD_DIR="${1:?build directory required}"
+SOURCE_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+FIXTURE="$BUILD_DIR/bench-fixture"
+VDAPP_SRC="$SOURCE_DIR/js/examples/bench/dist/bench.vdapp"
+
+if [[ ! -d "$VDAPP_SRC" ]]; then
+  echo "bench fixture missing: $VDAPP_SRC (run pnpm --dir js build first)" >&2
+  exit 1
+fi
+
+rm -rf "$FIXTURE"
+mkdir -p "$FIXTURE/installed-deck-apps"
+cp -R "$VDAPP_SRC" "$FIXTURE/installed-deck-apps/bench.vdapp"
+printf '%s' "bench.vdapp" >"$FIXTURE/active-package.txt"
+
+cd "$BUILD_DIR"
+export VITADECK_DATA_ROOT="$FIXTURE"
+
+HARNESS=(./bench_harness "${@:2}")
+if [[ -z "${DISPLAY:-}" ]] && command -v xvfb-run >/dev/null 2>&1; then
+  xvfb-run -a "${HARNESS[@]}"
+else
+  "${HARNESS[@]}"
+fi
@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+BUILD_DIR="${1:?build directory required}"
+SOURCE_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+UNAME="$(uname -s)"
+BASELINE="$SOURCE_DIR/tests/fixtures/perf_baseline.${UNAME}.json"
+TOLERANCES="$SOURCE_DIR/tests/fixtures/perf_tolerances.json"
+OUT_DIR="$BUILD_DIR/perf"
+
+if ! command -v node >/dev/null 2>&1; then
+  echo "perf gate: node is required to compare results" >&2
+  exit 1
+fi
+
+rm -rf "$OUT_DIR"
+mkdir -p "$OUT_DIR"
+
+"$SOURCE_DIR/tests/run_bench.sh" "$BUILD_DIR" --json "$OUT_DIR/reconciler.json"
+"$SOURCE_DIR/tests/run_render_bench.sh" "$BUILD_DIR" --json "$OUT_DIR/render.json"
+
+GATE=(node "$SOURCE_DIR/tests/perf_gate.mjs" --baseline "$BASELINE" --tolerances "$TOLERANCES"
+  --output "$OUT_DIR/results.json")
+if [[ ! -f "$BASELINE" && -n "${CI:-}" ]]; then
+  echo "perf gate: no baseline for ${UNAME} at ${BASELINE}; CI does not bootstrap one" >&2
+elif [[ ! -f "$BASELINE" ]]; then
+  echo "perf gate: bootstrapping baseline for ${UNAME} at ${BASELINE}"
+  GATE+=(--update-baseline)
+elif [[ "${VITADECK_PERF_UPDATE_BASELINE:-0}" == "1" ]]; then
+  GATE+=(--update-baseline)
+fi
+
+"${GATE[@]}" "$OUT_DIR/reconciler.json" "$OUT_DIR/render.json"
@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+BUILD_DIR="${1:?build directory required}"
+FIXTURE="$BUILD_DIR/render-bench-fixture"
+
+rm -rf "$FIXTURE"
+mkdir -p "$FIXTURE"
+
+cd "$BUILD_DIR"
+export VITADECK_DATA_ROOT="$FIXTURE"
+
+HARNESS=(./render_bench_harness "${@:2}")
+if [[ -z "${DISPLAY:-}" ]] && command -v xvfb-run >/dev/null 2>&1; then
+  xvfb-run -a "${HARNESS[@]}"
+else
+  "${HARNESS[@]}"
+fi
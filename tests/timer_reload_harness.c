@@ -69,6 +69,26 @@ int main(void)
         return 1;
     }
 
+    eval_or_die(ctx2,
+                "globalThis.order = '';"
+                "setTimeout(() => { globalThis.order += 'a'; setTimeout(() => { globalThis.order += 'd'; }, 0); }, 0);"
+                "const cancelled = setTimeout(() => { globalThis.order += 'x'; }, 0);"
+                "setTimeout(() => { globalThis.order += 'b'; }, 0);"
+                "clearTimeout(cancelled);"
+                "const interval = setInterval(() => { globalThis.order += 'c'; clearInterval(interval); }, 0);");
+    run_timeouts(ctx2);
+    run_timeouts(ctx2);
+
+    global = JS_GetGlobalObject(ctx2);
+    JSValue order_value = JS_GetPropertyStr(ctx2, global, "order");
+    const char *order = JS_ToCString(ctx2, order_value);
+    int order_ok = order && strcmp(order, "abcd") == 0;
+    if (!order_ok) fprintf(stderr, "expected FIFO timer order abcd, got %s\n", order ? order : "null");
+    JS_FreeCString(ctx2, order);
+    JS_FreeValue(ctx2, order_value);
+    JS_FreeValue(ctx2, global);
+    if (!order_ok) return 1;
+
     timeout_shutdown(ctx2);
     JS_FreeContext(ctx2);
     JS_FreeRuntime(rt2);